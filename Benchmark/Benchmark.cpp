@@ -0,0 +1,353 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Evaluator.h"
+#include "LineKernel.h"
+#include "MoveList.h"
+#include "PatternTable.h"
+#include "ThreatSpace.h"
+
+// Every heap allocation of the process, the timed searches report how many they made
+static std::atomic<std::size_t> AllocationCount{ 0 };
+
+void* operator new(std::size_t Size) {
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* Memory = std::malloc(Size != 0 ? Size : 1)) {
+        return Memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept {
+    std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept {
+    std::free(Memory);
+}
+
+// Times the engine on a fixed corpus, every position is printed as one JSON object per line
+class Benchmark {
+private:
+    struct Position {
+        const char* Name;
+        const char* Moves; // "Row,Column" pairs, black first; nullptr for the generated near-full board
+        int         VcxDepth;
+        bool        bIsVct;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+    Benchmark(int SearchDepth, std::size_t ThreadCount) :
+        _SearchDepth(SearchDepth), _ThreadCount(ThreadCount), _Sink(0), _bPassed(true)
+    {}
+
+    // False if a self-check failed, the failures are reported on stderr
+    bool Run() {
+        std::cout << "{\"benchmark\":\"gobang\",\"seed\":" << _kSeed << ",\"search_depth\":" << _SearchDepth
+                  << ",\"threads\":" << _ThreadCount << ",\"line_kernel\":\"" << LineKernel::GetInstance().GetLevelName() << "\""
+                  << ",\"statistics\":" << (SearchStatistics::kEnabled ? "true" : "false")
+                  << "}" << std::endl;
+
+        CheckLineKeys();
+        CheckVctDefenses();
+
+        for (const auto& Current : _kCorpus) {
+            std::cout << RunPosition(Current) << std::endl;
+        }
+
+        return _bPassed;
+    }
+
+private:
+    // The table lookup of Board::GetLineKey against matching the pattern strings on the cells themselves, read one by one
+    // with GetPawn, for both colours on every cell and line of seeded random boards from sparse to nearly full. This
+    // covers the key encoding and the white X/# swap as well as the table
+    void CheckLineKeys() {
+        const PatternTable& Patterns   = PatternTable::GetInstance();
+        std::mt19937_64     Engine(_kSeed);
+        int                 Mismatches = 0;
+        for (int Round = 0; Round != _kLineKeyBoards; ++Round) {
+            Board         Target;
+            std::uint64_t Density = Round % 10 + 1; // in twelfths of the board
+            for (int Index = 0; Index != kCellCount; ++Index) {
+                if (Engine() % 12 < Density) {
+                    Target.PutPawn({ Index / kBoardSize, Index % kBoardSize, Engine() % 2 == 0 ? Board::_kBlack : Board::_kWhite },
+                                   true, false);
+                }
+            }
+
+            for (int Index = 0; Index != kCellCount; ++Index) {
+                int Row    = Index / kBoardSize;
+                int Column = Index % kBoardSize;
+                for (int Direction = 0; Direction != 4; ++Direction) {
+                    for (Board::PawnType Type : { Board::_kBlack, Board::_kWhite }) {
+                        std::string Situation;
+                        for (int Offset = -4; Offset <= 4; ++Offset) {
+                            int CellRow    = Row    + Offset * Board::_kRowSteps[Direction];
+                            int CellColumn = Column + Offset * Board::_kColumnSteps[Direction];
+                            if (Offset == 0) {
+                                Situation.push_back('X');
+                            } else if (CellRow < 0 || CellColumn < 0 || CellRow >= kBoardSize || CellColumn >= kBoardSize) {
+                                Situation.push_back('-');
+                            } else {
+                                Board::PawnType Pawn = Target.GetPawn(CellRow, CellColumn);
+                                Situation.push_back(Pawn == Board::_kEmpty ? '_' : (Pawn == Type ? 'X' : '#'));
+                            }
+                        }
+
+                        std::uint16_t Expected = 0;
+                        for (std::size_t i = 0; i != PatternTable::kScoreMap.size(); ++i) {
+                            if (PatternTable::HasLayout(Situation, PatternTable::kScoreMap[i].Patterns)) {
+                                Expected |= static_cast<std::uint16_t>(1 << i);
+                            }
+                        }
+                        std::uint16_t Matches = Patterns.GetMatches(Target.GetLineKey(Row, Column, Direction, Type));
+                        Mismatches += Matches != Expected ||
+                                      PatternTable::GetLineLayout(Matches) != PatternTable::GetPawnLayout(Situation);
+                    }
+                }
+            }
+        }
+
+        if (Mismatches != 0) {
+            std::cerr << Mismatches << " line keys differ from the pattern strings on the board" << std::endl;
+            _bPassed = false;
+        }
+    }
+
+    // In the vct position, after 7,5 6,5 9,8 black has the split three 6,8 _ 8,8 9,8 on column 8. White also stops it
+    // on the far end 10,8, where black's 7,8 only makes a closed four. The generator before the threat space offered
+    // 7,8 alone and "proved" the vct at depth 11 without ever trying 10,8; with 10,8 it finds no win in the depth left,
+    // so the sound proof is two plies deeper
+    void CheckVctDefenses() {
+        auto Target = std::make_shared<Board>();
+        PlayMoves(*Target, "7,7 6,7 6,6 4,4 8,8 9,9 8,6 7,6 6,8 5,9 8,5 8,7 9,5 10,4 7,5 6,5 9,8");
+
+        Evaluator Engine(Target, Board::_kBlack, 2.5, 16, 1);
+        Engine.SyncCache(*Engine._Context);
+        MoveList Points;
+        Engine.FindVcxPoints(*Engine._Context, Board::_kWhite, true, Points);
+
+        bool bHasFarEnd = false;
+        for (const auto& Point : Points) {
+            bHasFarEnd = bHasFarEnd || (Point.Row == 10 && Point.Column == 8);
+        }
+
+        Target->PutPawn({ 10, 8, Board::_kWhite }, true, false);
+        bool bIsStopped = ThreatSpace::GetInstance().GetThreat(*Target, Board::ToIndex(7, 8), Board::_kBlack) <
+                          ThreatSpace::ThreatType::kOpenFour;
+        if (!bHasFarEnd || !bIsStopped) {
+            std::cerr << "VCT defender misses the far end of a split three" << std::endl;
+            _bPassed = false;
+        }
+    }
+
+    std::string RunPosition(const Position& Current) {
+        auto Target = std::make_shared<Board>();
+        if (Current.Moves != nullptr) {
+            PlayMoves(*Target, Current.Moves);
+        } else {
+            FillNearFull(*Target);
+        }
+
+        Board::PawnType SideToMove = Target->GetPawns(Board::_kBlack).Count() > Target->GetPawns(Board::_kWhite).Count() ?
+                                     Board::_kWhite : Board::_kBlack;
+        Evaluator Engine(Target, SideToMove, SideToMove == Board::_kBlack ? 2.5 : 0.5, 16, _ThreadCount);
+        Engine.SetSeed(_kSeed);
+        Engine._Context->ReserveMoveLists();
+        Engine.SyncCache(*Engine._Context);
+        _Sink = 0;
+
+        std::ostringstream Stream;
+        Stream << "{\"position\":\"" << Current.Name << "\",\"pawns\":" << Target->GetPawnCount()
+               << ",\"evaluate_ns\":" << TimeEvaluate(Engine, *Target)
+               << ",\"generate_us\":" << TimeGeneratePoints(Engine, SideToMove)
+               << ",\"evalboard_ns\":" << TimeEvalBoard(Engine)
+               << ",\"search\":" << TimeSearch(Engine)
+               << ",\"vcx\":" << TimeCalcKill(Engine, Current)
+               << ",\"dfpn\":" << TimeProofNumbers(Engine, Current)
+               << ",\"checksum\":" << _Sink << "}";
+
+        return Stream.str();
+    }
+
+    // Nanoseconds per Evaluate call, both colours on every empty cell
+    double TimeEvaluate(Evaluator& Engine, const Board& Target) {
+        std::size_t Calls     = 0;
+        auto        BeginTime = Clock::now();
+        for (int i = 0; i != _kEvaluateRounds; ++i) {
+            for (int Index : Target.GetPawns(Board::_kEmpty)) {
+                for (Board::PawnType Type : { Board::_kBlack, Board::_kWhite }) {
+                    Board::PawnInfo Point{ Index / kBoardSize, Index % kBoardSize, Type };
+                    _Sink += Engine.Evaluate(*Engine._Context, Point);
+                    ++Calls;
+                }
+            }
+        }
+
+        return Calls == 0 ? 0.0 : GetSeconds(BeginTime) * 1e9 / Calls;
+    }
+
+    double TimeGeneratePoints(Evaluator& Engine, Board::PawnType SideToMove) {
+        MoveList Points;
+        auto     BeginTime = Clock::now();
+        for (int i = 0; i != _kGenerateRounds; ++i) {
+            Engine.GeneratePoints(*Engine._Context, SideToMove, Points);
+            _Sink += Points.Size();
+        }
+
+        return GetSeconds(BeginTime) * 1e6 / _kGenerateRounds;
+    }
+
+    double TimeEvalBoard(Evaluator& Engine) {
+        auto BeginTime = Clock::now();
+        for (int i = 0; i != _kEvalBoardRounds; ++i) {
+            _Sink += Engine.EvalBoard(*Engine._Context);
+        }
+
+        return GetSeconds(BeginTime) * 1e9 / _kEvalBoardRounds;
+    }
+
+    // Nodes are counted by the main thread only, helper threads add to the time but not to the count
+    std::string TimeSearch(Evaluator& Engine) {
+        Evaluator::SearchLimits Limits;
+        Limits.MaxDepth = _SearchDepth;
+
+        std::size_t     FirstNode   = Engine._Context->_NodeCount;
+        std::size_t     Allocations = AllocationCount;
+        auto            BeginTime   = Clock::now();
+        Board::PawnInfo Move        = Engine.GetBestMove(Limits);
+        double          Seconds     = GetSeconds(BeginTime);
+        std::size_t     Nodes       = Engine._Context->_NodeCount - FirstNode;
+        Allocations = AllocationCount - Allocations;
+
+        // Move lists are reserved up front, so a single threaded search must not touch the heap
+        if (_ThreadCount <= 1 && Allocations != 0) {
+            std::cerr << "GetBestMove made " << Allocations << " allocations after warm-up" << std::endl;
+            _bPassed = false;
+        }
+
+        std::ostringstream Stream;
+        Stream << "{\"depth\":" << _SearchDepth << ",\"seconds\":" << Seconds << ",\"nodes\":" << Nodes
+               << ",\"nps\":" << (Seconds > 0.0 ? Nodes / Seconds : 0.0)
+               << ",\"allocations\":" << Allocations << ",\"move\":[" << Move.Row << "," << Move.Column << "]";
+        if constexpr (SearchStatistics::kEnabled) {
+            Stream << ",\"statistics\":" << Engine.GetStatistics().ToJson();
+        }
+        Stream << "}";
+
+        return Stream.str();
+    }
+
+    // Odd depths only, so the attacker always makes the last move of a proof
+    std::string TimeCalcKill(Evaluator& Engine, const Position& Current) {
+        Engine.SyncCache(*Engine._Context);
+
+        std::size_t     FirstNode   = Engine._Context->_NodeCount;
+        std::size_t     Allocations = AllocationCount;
+        auto            BeginTime   = Clock::now();
+        Board::PawnInfo Move        = Engine.DeepingCalcKill(*Engine._Context, 1, Current.VcxDepth, Current.bIsVct);
+        double          Seconds     = GetSeconds(BeginTime);
+        Allocations = AllocationCount - Allocations;
+
+        std::ostringstream Stream;
+        Stream << "{\"vct\":" << (Current.bIsVct ? "true" : "false") << ",\"depth\":" << Current.VcxDepth
+               << ",\"seconds\":" << Seconds << ",\"nodes\":" << Engine._Context->_NodeCount - FirstNode
+               << ",\"allocations\":" << Allocations
+               << ",\"found\":" << (Move.Type != Board::_kEmpty ? "true" : "false")
+               << ",\"move\":[" << Move.Row << "," << Move.Column << "]}";
+
+        return Stream.str();
+    }
+
+    // Same threat type as TimeCalcKill, without a depth limit
+    std::string TimeProofNumbers(Evaluator& Engine, const Position& Current) {
+        Engine.SyncCache(*Engine._Context);
+
+        std::size_t     FirstNode   = Engine._Context->_NodeCount;
+        std::size_t     Allocations = AllocationCount;
+        auto            BeginTime   = Clock::now();
+        Board::PawnInfo Move        = Engine.SolveProofNumbers(*Engine._Context, Current.bIsVct, _kProofNumberNodes);
+        double          Seconds     = GetSeconds(BeginTime);
+        Allocations = AllocationCount - Allocations;
+
+        std::ostringstream Stream;
+        Stream << "{\"vct\":" << (Current.bIsVct ? "true" : "false")
+               << ",\"seconds\":" << Seconds << ",\"nodes\":" << Engine._Context->_NodeCount - FirstNode
+               << ",\"allocations\":" << Allocations
+               << ",\"found\":" << (Move.Type != Board::_kEmpty ? "true" : "false")
+               << ",\"move\":[" << Move.Row << "," << Move.Column << "]}";
+
+        return Stream.str();
+    }
+
+    static void PlayMoves(Board& Target, const char* Moves) {
+        std::istringstream Stream(Moves);
+        Board::PawnType    Type   = Board::_kBlack;
+        int                Row    = 0;
+        int                Column = 0;
+        char               Comma  = 0;
+        while (Stream >> Row >> Comma >> Column) {
+            Target.PutPawn({ Row, Column, Type }, true, false);
+            Type = 3 - Type;
+        }
+    }
+
+    // Pairs of columns shifted by one every row never line up five of a colour; a sparse set of cells stays empty
+    static void FillNearFull(Board& Target) {
+        for (int x = 0; x != kBoardSize; ++x) {
+            for (int y = 0; y != kBoardSize; ++y) {
+                if ((x * 7 + y * 3) % 9 == 0) {
+                    continue;
+                }
+                Target.PutPawn({ x, y, (y + 2 * x) / 2 % 2 == 0 ? Board::_kBlack : Board::_kWhite }, true, false);
+            }
+        }
+    }
+
+    static double GetSeconds(Clock::time_point BeginTime) {
+        return std::chrono::duration<double>(Clock::now() - BeginTime).count();
+    }
+
+private:
+    static constexpr std::uint64_t _kSeed             = 20240601;
+    static constexpr int           _kEvaluateRounds   = 200;
+    static constexpr int           _kGenerateRounds   = 2000;
+    static constexpr int           _kEvalBoardRounds  = 1000000;
+    static constexpr std::size_t   _kProofNumberNodes = 1000000;
+    static constexpr int           _kLineKeyBoards    = 200;
+
+    static constexpr Position _kCorpus[] = {
+        { "opening",   "7,7 6,7 6,6 4,4",                                                    11, false },
+        { "midgame",   "7,7 6,7 6,6 4,4 8,8 9,9 8,6 7,6 6,8 5,9 8,5 8,7",                    11, false },
+        { "vcf",       "7,7 6,6 5,7 6,7 6,8 4,6 5,9 8,6 7,6 7,5 5,8 5,6 7,8 4,8",            15, false },
+        { "vct",       "7,7 6,7 6,6 4,4 8,8 9,9 8,6 7,6 6,8 5,9 8,5 8,7 9,5 10,4",            13, true  },
+        { "near_full", nullptr,                                                              11, false },
+    };
+
+    int           _SearchDepth;
+    std::size_t   _ThreadCount;
+    std::uint64_t _Sink; // printed as the checksum, keeps the timed calls from being optimized away
+    bool          _bPassed;
+};
+
+int main(int argc, char** argv) {
+    int         SearchDepth = argc > 1 ? std::atoi(argv[1]) : 8;
+    std::size_t ThreadCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+    Benchmark Suite(SearchDepth, ThreadCount);
+
+    return Suite.Run() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
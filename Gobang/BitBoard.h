@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+class BitBoard {
+public:
+    static constexpr int kWordCount = 4; // 256 bits, enough for the 15x15 grid
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = int;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const int*;
+        using reference         = int;
+
+    public:
+        Iterator() = default;
+        Iterator(const std::array<std::uint64_t, kWordCount>* Words, int WordIndex) : _Words(Words), _WordIndex(WordIndex) {
+            if (_Words != nullptr) {
+                _Current = (*_Words)[_WordIndex];
+                SkipEmptyWords();
+            }
+        }
+
+        int operator*() const {
+            return _WordIndex * 64 + std::countr_zero(_Current);
+        }
+
+        Iterator& operator++() {
+            _Current &= _Current - 1;
+            SkipEmptyWords();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator Previous = *this;
+            ++*this;
+            return Previous;
+        }
+
+        bool operator==(const Iterator& Other) const {
+            return _WordIndex == Other._WordIndex && _Current == Other._Current;
+        }
+
+    private:
+        void SkipEmptyWords() {
+            while (_Current == 0 && _WordIndex + 1 < kWordCount) {
+                _Current = (*_Words)[++_WordIndex];
+            }
+            if (_Current == 0) {
+                _WordIndex = kWordCount;
+            }
+        }
+
+    private:
+        const std::array<std::uint64_t, kWordCount>* _Words     = nullptr;
+        int                                          _WordIndex = kWordCount;
+        std::uint64_t                                _Current   = 0;
+    };
+
+public:
+    constexpr BitBoard() = default;
+
+    constexpr bool Test(int Index) const {
+        return (_Words[Index >> 6] >> (Index & 63)) & 1;
+    }
+
+    constexpr void Set(int Index) {
+        _Words[Index >> 6] |= std::uint64_t(1) << (Index & 63);
+    }
+
+    constexpr void Reset(int Index) {
+        _Words[Index >> 6] &= ~(std::uint64_t(1) << (Index & 63));
+    }
+
+    constexpr bool Any() const {
+        return (_Words[0] | _Words[1] | _Words[2] | _Words[3]) != 0;
+    }
+
+    constexpr bool Intersects(const BitBoard& Other) const {
+        return ((_Words[0] & Other._Words[0]) | (_Words[1] & Other._Words[1]) |
+                (_Words[2] & Other._Words[2]) | (_Words[3] & Other._Words[3])) != 0;
+    }
+
+    constexpr int Count() const {
+        return std::popcount(_Words[0]) + std::popcount(_Words[1]) + std::popcount(_Words[2]) + std::popcount(_Words[3]);
+    }
+
+    constexpr BitBoard operator&(const BitBoard& Other) const {
+        BitBoard Result;
+        for (int i = 0; i != kWordCount; ++i) {
+            Result._Words[i] = _Words[i] & Other._Words[i];
+        }
+        return Result;
+    }
+
+    constexpr BitBoard operator|(const BitBoard& Other) const {
+        BitBoard Result;
+        for (int i = 0; i != kWordCount; ++i) {
+            Result._Words[i] = _Words[i] | Other._Words[i];
+        }
+        return Result;
+    }
+
+    constexpr bool operator==(const BitBoard& Other) const = default;
+
+    Iterator begin() const {
+        return Iterator(&_Words, 0);
+    }
+
+    Iterator end() const {
+        return Iterator();
+    }
+
+private:
+    std::array<std::uint64_t, kWordCount> _Words{};
+};
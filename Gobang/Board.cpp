@@ -1,10 +1,69 @@
 #include "Board.h"
 
-#ifdef _DEBUG
-#include <QDebug>
-#endif // _DEBUG
+#include <algorithm>
+#include <random>
 
-Board::Board() : _PawnsMap(kBoardSize, std::vector<int>(kBoardSize, 0)), _PawnCount(0) {}
+namespace {
+    Board::NeighborTable MakeNeighbors() {
+        Board::NeighborTable Neighbors{};
+        for (int x = 0; x != kBoardSize; ++x) {
+            for (int y = 0; y != kBoardSize; ++y) {
+                for (int Row = std::max(x - 2, 0); Row <= std::min(x + 2, kBoardSize - 1); ++Row) {
+                    for (int Column = std::max(y - 2, 0); Column <= std::min(y + 2, kBoardSize - 1); ++Column) {
+                        if (Row != x || Column != y) {
+                            Neighbors[Board::ToIndex(x, y)].Set(Board::ToIndex(Row, Column));
+                        }
+                    }
+                }
+            }
+        }
+
+        return Neighbors;
+    }
+
+    // The raw mt19937_64 output is specified by the standard, so keys match across toolchains
+    Board::ZobristTable MakeZobrist() {
+        Board::ZobristTable Keys{};
+        std::mt19937_64 Engine(0x476F62616E67ULL);
+        for (int Index = 0; Index != kCellCount; ++Index) {
+            Keys[0][Index] = Engine();
+            Keys[1][Index] = Engine();
+        }
+
+        return Keys;
+    }
+}
+
+Board::Board() : _PawnCount(0), _HashCode(0), _NeighborCounts{} {
+    for (auto& Lines : _Lines) {
+        Lines.fill((std::uint64_t(1) << (2 * (kBoardSize + 8))) - 1);
+    }
+
+    for (int x = 0; x != kBoardSize; ++x) {
+        for (int y = 0; y != kBoardSize; ++y) {
+            _Pawns[_kEmpty].Set(ToIndex(x, y));
+            for (int Direction = 0; Direction != 4; ++Direction) {
+                auto [Line, Position] = GetLineSlot(x, y, Direction);
+                _Lines[Direction][Line] &= ~(std::uint64_t(3) << (2 * (Position + 4)));
+            }
+        }
+    }
+}
+
+Board::Board(const Board& Other) :
+    _Pawns(Other._Pawns), _Lines(Other._Lines), _PawnCount(Other._PawnCount), _HashCode(Other._HashCode),
+    _Candidates(Other._Candidates), _NeighborCounts(Other._NeighborCounts)
+{}
+
+Board& Board::operator=(const Board& Other) {
+    _Pawns          = Other._Pawns;
+    _Lines          = Other._Lines;
+    _PawnCount      = Other._PawnCount;
+    _HashCode       = Other._HashCode;
+    _Candidates     = Other._Candidates;
+    _NeighborCounts = Other._NeighborCounts;
+    return *this;
+}
 
 std::pair<Board::PawnInfo, bool> Board::PutPawn(const PawnInfo& Pawn, bool bIsNormalized, bool bDrawPawn) {
     PawnInfo Final{};
@@ -33,6 +92,9 @@ std::pair<Board::PawnInfo, bool> Board::PutPawn(const PawnInfo& Pawn, bool bIsNo
             Final = BottomLeft;
         } else if (LeftMod > GridSizeDouble / 2 && TopMod > GridSizeDouble / 2) {
             Final = BottomRight;
+        } else {
+            // Midline between two cells, no cell to pick
+            return { {}, false };
         }
     } else {
         Final = Pawn;
@@ -43,10 +105,11 @@ std::pair<Board::PawnInfo, bool> Board::PutPawn(const PawnInfo& Pawn, bool bIsNo
         return { {}, true };
     }
 
-    if (_PawnsMap[Final.Row][Final.Column] == 0 &&
-        _PawnsMap[Final.Row][Final.Column] != Pawn.Type) {
+    if (_Pawns[_kEmpty].Test(ToIndex(Final.Row, Final.Column))) {
         if (bDrawPawn) {
-            Q_EMIT Signal_PaintEvent(Final);
+            for (const auto& Listener : _Listeners) {
+                Listener(Final);
+            }
         }
         PawnConfirm(Final);
         return { Final, true };
@@ -56,14 +119,49 @@ std::pair<Board::PawnInfo, bool> Board::PutPawn(const PawnInfo& Pawn, bool bIsNo
 }
 
 void Board::PawnConfirm(const PawnInfo& Pawn) {
-    _PawnsMap[Pawn.Row][Pawn.Column] = Pawn.Type;
+    int Index = ToIndex(Pawn.Row, Pawn.Column);
     if (Pawn.Type != 0) {
+        _Pawns[_kEmpty].Reset(Index);
+        _Pawns[Pawn.Type].Set(Index);
+        _HashCode ^= GetZobrist(Index, Pawn.Type);
         ++_PawnCount;
+
+        _Candidates.Reset(Index);
+        for (int Neighbor : _kNeighbors[Index]) {
+            if (_NeighborCounts[Neighbor]++ == 0 && _Pawns[_kEmpty].Test(Neighbor)) {
+                _Candidates.Set(Neighbor);
+            }
+        }
     } else {
+        PawnType Revoked = GetPawn(Pawn.Row, Pawn.Column);
+        if (Revoked == _kEmpty) {
+            return;
+        }
+        _HashCode ^= GetZobrist(Index, Revoked);
+        _Pawns[Revoked].Reset(Index);
+        _Pawns[_kEmpty].Set(Index);
         --_PawnCount;
+
+        for (int Neighbor : _kNeighbors[Index]) {
+            if (--_NeighborCounts[Neighbor] == 0) {
+                _Candidates.Reset(Neighbor);
+            }
+        }
+        if (_NeighborCounts[Index] != 0) {
+            _Candidates.Set(Index);
+        }
+    }
+
+    for (int Direction = 0; Direction != 4; ++Direction) {
+        auto [Line, Position] = GetLineSlot(Pawn.Row, Pawn.Column, Direction);
+        std::uint64_t& Bits = _Lines[Direction][Line];
+        Bits = (Bits & ~(std::uint64_t(3) << (2 * (Position + 4)))) | (std::uint64_t(Pawn.Type) << (2 * (Position + 4)));
     }
 }
 
 const Board::PawnType Board::_kEmpty = 0;
 const Board::PawnType Board::_kBlack = 1;
 const Board::PawnType Board::_kWhite = 2;
+
+const Board::NeighborTable Board::_kNeighbors = MakeNeighbors();
+const Board::ZobristTable  Board::_kZobrist   = MakeZobrist();
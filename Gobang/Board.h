@@ -1,19 +1,22 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
-#include <QObject>
+
+#include "BitBoard.h"
 
 const int kMargin    = 30;
 const int kGridSize  = 46;
 const int kPawnSize  = 46;
 const int kBoardSize = 15;
 const int kTexSize   = 700;
+const int kCellCount = kBoardSize * kBoardSize;
 
-class Board : public QObject {
-    Q_OBJECT
-
+class Board {
 public:
     using PawnType = int;
 
@@ -24,31 +27,154 @@ public:
         int      Score  = 0;
     };
 
+    // Read-only view keeping the old GetPawnsMap()[Row][Column] syntax working on top of the bitboards
+    class PawnsMapView {
+    public:
+        class RowView {
+        public:
+            RowView(const Board* Owner, int Row) : _Owner(Owner), _Row(Row) {}
+
+            PawnType operator[](int Column) const {
+                return _Owner->GetPawn(_Row, Column);
+            }
+
+        private:
+            const Board* _Owner;
+            int          _Row;
+        };
+
+    public:
+        explicit PawnsMapView(const Board* Owner) : _Owner(Owner) {}
+
+        RowView operator[](int Row) const {
+            return RowView(_Owner, Row);
+        }
+
+    private:
+        const Board* _Owner;
+    };
+
+    using NeighborTable = std::array<BitBoard, kCellCount>;
+    using ZobristTable  = std::array<std::array<std::uint64_t, kCellCount>, 2>;
+    using PawnListener  = std::function<void(const PawnInfo& Pawn)>;
+
 public:
     Board();
+    // Copies the position only, listeners stay with the original
+    Board(const Board& Other);
+    Board& operator=(const Board& Other);
+
     std::pair<PawnInfo, bool> PutPawn(const PawnInfo& Pawn, bool bIsNormalized = false, bool bDrawPawn = true);
 
+    // Listeners are told about every pawn put with bDrawPawn, search moves never reach them
+    void Subscribe(PawnListener Listener) {
+        _Listeners.push_back(std::move(Listener));
+    }
+
 private:
     void PawnConfirm(const PawnInfo& Pawn);
 
+    // Every line is stored with 4 off-board cells padded on both ends, so a cell's window starts at its position
+    static std::pair<int, int> GetLineSlot(int Row, int Column, int Direction) {
+        switch (Direction) {
+        case 0:
+            return { Column, Row };
+        case 1:
+            return { Row, Column };
+        case 2:
+            return { Column - Row + kBoardSize - 1, Row };
+        default:
+            return { Row + Column, Row };
+        }
+    }
+
 public:
-    const std::vector<std::vector<int>>& GetPawnsMap() const {
-        return _PawnsMap;
+    static int ToIndex(int Row, int Column) {
+        return Row * kBoardSize + Column;
+    }
+
+    // Nine cells centered on (Row, Column) along Direction (0 vertical, 1 horizontal, 2 backslash, 3 slash), 2 bits per
+    // cell holding the PawnType (3 off the board), the cell at offset -4 in the lowest bits
+    int GetLineWindow(int Row, int Column, int Direction) const {
+        auto [Line, Position] = GetLineSlot(Row, Column, Direction);
+        return static_cast<int>((_Lines[Direction][Line] >> (2 * Position)) & 0x3FFFF);
+    }
+
+    // Packed line through (Row, Column) along Direction and the cell's position in it, the window of the cell at
+    // position P is (Line >> 2 * P) & 0x3FFFF. Cells of one line have consecutive positions, in the order of
+    // _kRowSteps and _kColumnSteps
+    std::pair<std::uint64_t, int> GetLine(int Row, int Column, int Direction) const {
+        auto [Line, Position] = GetLineSlot(Row, Column, Direction);
+        return { _Lines[Direction][Line], Position };
+    }
+
+    // The 8 neighbours of (Row, Column) along Direction as seen by Type, 2 bits each ('_' 0, 'X' 1, '#' 2, '-' 3),
+    // offsets -4..-1 then 1..4 from the lowest bits
+    int GetLineKey(int Row, int Column, int Direction, PawnType Type) const {
+        int Window = GetLineWindow(Row, Column, Direction);
+        int Key    = (Window & 0xFF) | (Window >> 10 << 8);
+        if (Type == _kWhite) {
+            Key ^= ((Key ^ (Key >> 1)) & 0x5555) * 3;
+        }
+        return Key;
+    }
+
+    PawnType GetPawn(int Row, int Column) const {
+        int Index = ToIndex(Row, Column);
+        if (_Pawns[_kBlack].Test(Index)) {
+            return _kBlack;
+        }
+        return _Pawns[_kWhite].Test(Index) ? _kWhite : _kEmpty;
+    }
+
+    // Zobrist key of a pawn of Type (black or white) on Index. Fixed for the whole program, so hashes of the same
+    // position match across boards, searches and runs
+    static std::uint64_t GetZobrist(int Index, PawnType Type) {
+        return _kZobrist[Type - 1][Index];
+    }
+
+    // Zobrist hash of every pawn on the board, kept up to date by PutPawn whether the pawn is a real move or a
+    // search move
+    std::uint64_t GetHashCode() const {
+        return _HashCode;
+    }
+
+    // Indexed by PawnType, GetPawns(_kEmpty) yields the empty cells
+    const BitBoard& GetPawns(PawnType Type) const {
+        return _Pawns[Type];
+    }
+
+    // Empty cells within 2 steps (rows and columns) of any pawn, the only cells where a pattern can form.
+    // Empty on an empty board
+    const BitBoard& GetCandidates() const {
+        return _Candidates;
+    }
+
+    PawnsMapView GetPawnsMap() const {
+        return PawnsMapView(this);
     }
 
     const std::size_t GetPawnCount() const {
         return _PawnCount;
     }
 
-signals:
-    void Signal_PaintEvent(const PawnInfo& Pawn);
-
 public:
     static const PawnType _kEmpty;
     static const PawnType _kBlack;
     static const PawnType _kWhite;
 
+    static constexpr std::array<int, 4> _kRowSteps    = { 1, 0, 1,  1 };
+    static constexpr std::array<int, 4> _kColumnSteps = { 0, 1, 1, -1 };
+
 private:
-    std::vector<std::vector<int>> _PawnsMap;
-    std::size_t                   _PawnCount;
+    static const NeighborTable _kNeighbors;
+    static const ZobristTable  _kZobrist;
+
+    std::array<BitBoard, 3>                                     _Pawns;
+    std::array<std::array<std::uint64_t, 2 * kBoardSize - 1>, 4> _Lines;
+    std::size_t                                                 _PawnCount;
+    std::uint64_t                                               _HashCode;
+    BitBoard                                                    _Candidates;
+    std::array<std::uint8_t, kCellCount>                        _NeighborCounts; // pawns within the 5x5 square of each cell
+    std::vector<PawnListener>                                   _Listeners;
 };
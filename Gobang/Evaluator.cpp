@@ -1,150 +1,355 @@
 ﻿#include "Evaluator.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
-#include <format>
-#include <iostream>
 #include <limits>
+#include <random>
+#include <string_view>
+
+Evaluator::Evaluator(std::shared_ptr<Board> Board, Board::PawnType PawnType, double Aggressiveness,
+                     std::size_t TableSizeInMB, std::size_t ThreadCount, std::size_t ProofTableSizeInMB) :
+    _Board(Board), _MachinePawn(PawnType), _Aggressiveness(Aggressiveness), _Patterns(PatternTable::GetInstance()),
+    _ThreatSpace(ThreatSpace::GetInstance()), _LineKernel(LineKernel::GetInstance()),
+    _TranspositionTable(std::make_shared<TranspositionTable>(TableSizeInMB))
+{
+    _Context = std::make_unique<SearchContext>(*this, *_Board, ThreadCount, ProofTableSizeInMB);
+}
 
-#ifdef _DEBUG
-#include <QDebug>
-#endif // _DEBUG
+void Evaluator::SetSeed(std::uint64_t Seed) {
+    _Context->SetSeed(Seed);
+}
 
-Evaluator::Evaluator(std::shared_ptr<Board> Board, Board::PawnType PawnType, double Aggressiveness) :
-    _Board(Board), _BestMove({}), _MachinePawn(PawnType), _Aggressiveness(Aggressiveness), _HashCode(0),
-    _kFiveLink({ "XXXXX" }), // 连五
-    _kFour({ "_XXXX_" }), // 活四
-    _kThree({ "_XXX__", "_XX_X_", "_X_XX_", "__XXX_" }), // 活三
-    _kBlockFour({ "_XXXX", "X_XXX", "XX_XX", "XXX_X", "XXXX_" }), // 冲四
-    _kTwo({ "__XX__", "_XX___", "___XX_", "_X_X__", "__X_X_" }), // 活二
-    _kOne({ "_X_#__", "__#_X_", "_#_X__", "__X_#_", "#_X___", "___X_#", "___#_X", "X_#___" }), // 活一
-    _kBlockThree({ "#XXX__", "#XX_X_", "#X_XX_", "__XXX#", "_X_XX#", "_XX_X#" }), // 眠三
-    _kBlockTwo({ "_XX#__", "__XX#_", "__#XX_", "_#XX__", "___XX#", "#XX___", "XX____", "____XX" }), // 眠二
-    _kBlockOne({ "__X#__", "__#X__", "___#X_", "_X#___", "#X____", "____X#" }), // 眠一
-    _BlackZobrist(kBoardSize, std::vector<long long>(kBoardSize, 0)),
-    _WhiteZobrist(kBoardSize, std::vector<long long>(kBoardSize, 0))
-{
-    _ScoreMap.push_back({ _kFiveLink,   PawnLayout::kFiveLink });
-    _ScoreMap.push_back({ _kFour,       PawnLayout::kFour });
-    _ScoreMap.push_back({ _kThree,      PawnLayout::kThree });
-    _ScoreMap.push_back({ _kBlockFour,  PawnLayout::kBlockFour });
-    _ScoreMap.push_back({ _kTwo,        PawnLayout::kTwo });
-    _ScoreMap.push_back({ _kOne,        PawnLayout::kOne });
-    _ScoreMap.push_back({ _kBlockThree, PawnLayout::kBlockThree });
-    _ScoreMap.push_back({ _kBlockTwo,   PawnLayout::kBlockTwo });
-    _ScoreMap.push_back({ _kBlockOne,   PawnLayout::kBlockOne });
-
-    std::mt19937_64 Engine(std::random_device{}());
-    std::uniform_int_distribution<long long> Distribution;
-    for (int x = 0; x != kBoardSize; ++x) {
-        for (int y = 0; y != kBoardSize; ++y) {
-            _BlackZobrist[x][y] = Distribution(Engine);
-            _WhiteZobrist[x][y] = Distribution(Engine);
-        }
-    }
+void Evaluator::ReserveMoveLists() {
+    _Context->ReserveMoveLists();
 }
 
-bool Evaluator::IsGameOver(const Board::PawnInfo& LatestPawn) {
-    if (HasLayoutNearPawn(LatestPawn, _kFiveLink) || _Board->GetPawnCount() == 225U) {
+bool Evaluator::IsGameOver(const Board::PawnInfo& LatestPawn) const {
+    if (HasLayoutNearPawn(*_Board, LatestPawn, PawnLayout::kFiveLink) || _Board->GetPawnCount() == 225U) {
         return true;
     } else {
         return false;
     }
 }
 
-Board::PawnInfo Evaluator::GetBestMove(int MaxDepth, bool bProcessCalcKill, int MaxVcxDepth, bool bIsVct, int NextDepth) {
-    DeepingMinimax(2, MaxDepth);
-    if (!bProcessCalcKill) {
-        return _BestMove;
+Board::PawnInfo Evaluator::GetBestMove(const SearchLimits& Limits) {
+    _Context->SetPosition(*_Board);
+    return GetBestMove(*_Context, Limits);
+}
+
+Board::PawnInfo Evaluator::GetBestMove(SearchContext& Context, const SearchLimits& Limits) const {
+    auto BeginTime = std::chrono::steady_clock::now();
+    Context._SoftDeadline = Limits.SoftTime.count() > 0 ? BeginTime + Limits.SoftTime : std::chrono::steady_clock::time_point::max();
+    Context._HardDeadline = Limits.HardTime.count() > 0 ? BeginTime + Limits.HardTime : std::chrono::steady_clock::time_point::max();
+    Context._SoftDeadline = std::min(Context._SoftDeadline, Context._HardDeadline);
+    Context._NodeLimit    = Limits.NodeLimit > 0 ? Context._NodeCount + Limits.NodeLimit : std::numeric_limits<std::size_t>::max();
+    Context._BestMove     = {};
+    Context._KillMove     = {};
+    Context._Statistics.Reset();
+    for (auto& Helper : Context._Helpers) {
+        Helper->_Statistics.Reset();
+    }
+
+    Board::PawnInfo BestMove = SearchBestMove(Context, Limits);
+
+    if constexpr (SearchStatistics::kEnabled) {
+        for (const auto& Helper : Context._Helpers) {
+            Context._Statistics.Merge(Helper->_Statistics);
+        }
+        Context._Statistics.SetSeconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - BeginTime).count());
+    }
+
+    return BestMove;
+}
+
+Board::PawnInfo Evaluator::SearchBestMove(SearchContext& Context, const SearchLimits& Limits) const {
+    SyncCache(Context);
+    Board::PawnInfo ForcedMove = FindForcedMove(Context);
+    if (ForcedMove.Type != Board::_kEmpty) {
+        Context._BestMove = ForcedMove;
+        return ForcedMove;
+    }
+
+    _TranspositionTable->NewSearch();
+    Context.ClearMoveOrdering();
+    StartHelpers(Context, HelperTask::kMinimax, Limits.MaxDepth, false);
+    DeepingMinimax(Context, 2, Limits.MaxDepth);
+    StopHelpers(Context);
+    if (!Limits.bProcessCalcKill || std::chrono::steady_clock::now() >= Context._HardDeadline ||
+        Context._NodeCount >= Context._NodeLimit) {
+        return Context._BestMove;
     } else {
-        if (!HasLayoutNearPawn(_BestMove, _kFiveLink)) {
-            Board::PawnInfo VcxPoint = DeepingCalcKill(NextDepth, MaxVcxDepth, bIsVct);
+        if (!HasLayoutNearPawn(Context._Board, Context._BestMove, PawnLayout::kFiveLink)) {
+            Board::PawnInfo VcxPoint = Limits.Solver == VcxSolver::kProofNumber ?
+                                       SolveProofNumbers(Context, Limits.bIsVct, Limits.MaxVcxNodes) :
+                                       DeepingCalcKill(Context, Limits.NextVcxDepth, Limits.MaxVcxDepth, Limits.bIsVct);
             if (VcxPoint.Type != 0) {
-                std::cout << std::format("Calculate kill: ({}, {})", VcxPoint.Row, VcxPoint.Column) << std::endl;
+                Context._KillMove = VcxPoint;
                 return VcxPoint;
             } else {
-                return _BestMove;
+                return Context._BestMove;
             }
         } else {
-            return _BestMove;
+            return Context._BestMove;
+        }
+    }
+}
+
+// A five of the own is played at once, and so is the only cell stopping a five of the opponent. The search picks the
+// same move in both cases, here it costs one pass over the candidates instead of waking the helpers
+Board::PawnInfo Evaluator::FindForcedMove(const SearchContext& Context) const {
+    Board::PawnInfo Block{};
+    int             BlockCount = 0;
+    for (int Index : Context._Board.GetCandidates()) {
+        Board::PawnInfo Point{ Index / kBoardSize, Index % kBoardSize, _MachinePawn };
+        if (Evaluate(Context, Point) >= GetScore(PawnLayout::kFiveLink)) {
+            return Point;
+        }
+
+        Board::PawnInfo FoePoint{ Point.Row, Point.Column, 3 - _MachinePawn };
+        if (Evaluate(Context, FoePoint) >= GetScore(PawnLayout::kFiveLink)) {
+            Block = Point;
+            ++BlockCount;
         }
     }
+
+    return BlockCount == 1 ? Block : Board::PawnInfo{};
 }
 
-int Evaluator::Minimax(int CurrentDepth, int NextDepth, int Alpha, int Beta, Board::PawnType PawnType) {
+void Evaluator::StartHelpers(SearchContext& Context, HelperTask Task, int MaxDepth, bool bIsVct) const {
+    Context._bStopSearch = false;
+    if (Context._Helpers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(Context._Mutex);
+        for (auto& Helper : Context._Helpers) {
+            Helper->_Board        = Context._Board;
+            Helper->_HardDeadline = Context._HardDeadline;
+        }
+        Context._HelperTask     = Task;
+        Context._HelperMaxDepth = MaxDepth;
+        Context._bHelperIsVct   = bIsVct;
+        Context._ActiveHelpers  = Context._Helpers.size();
+        ++Context._SearchCount;
+    }
+    Context._Condition.notify_all();
+}
+
+void Evaluator::StopHelpers(SearchContext& Context) const {
+    Context._bStopSearch = true;
+    WaitHelpers(Context);
+    Context._bStopSearch = false;
+}
+
+void Evaluator::WaitHelpers(SearchContext& Context) const {
+    std::unique_lock<std::mutex> Lock(Context._Mutex);
+    Context._Condition.wait(Lock, [&]() -> bool { return Context._ActiveHelpers == 0; });
+}
+
+void Evaluator::HelperLoop(SearchContext& Context, std::size_t Index) const {
+    std::size_t LastSearch = 0;
+    while (true) {
+        HelperTask Task     = HelperTask::kMinimax;
+        int        MaxDepth = 0;
+        bool       bIsVct   = false;
+        {
+            std::unique_lock<std::mutex> Lock(Context._Mutex);
+            Context._Condition.wait(Lock, [&]() -> bool { return Context._bQuit || Context._SearchCount != LastSearch; });
+            if (Context._bQuit) {
+                return;
+            }
+            LastSearch = Context._SearchCount;
+            Task       = Context._HelperTask;
+            MaxDepth   = Context._HelperMaxDepth;
+            bIsVct     = Context._bHelperIsVct;
+        }
+
+        SearchContext& Helper = *Context._Helpers[Index];
+        SyncCache(Helper);
+        switch (Task) {
+        case HelperTask::kMinimax:
+            Helper.ClearMoveOrdering();
+            // Half of the helpers skip the first iteration so the threads spread over different depths
+            DeepingMinimax(Helper, Index % 2 == 0 ? 4 : 2, MaxDepth);
+            break;
+        case HelperTask::kCalcKill:
+            ProcessVcxTasks(Context, Helper, bIsVct);
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(Context._Mutex);
+            --Context._ActiveHelpers;
+        }
+        Context._Condition.notify_all();
+    }
+}
+
+void Evaluator::ProcessVcxTasks(SearchContext& Context, SearchContext& Worker, bool bIsVct) const {
+    while (true) {
+        SearchContext::VcxTask Task;
+        {
+            std::lock_guard<std::mutex> Lock(Context._Mutex);
+            if (Context._VcxTasks.empty() || Context._bStopSearch) {
+                return;
+            }
+            // Like DeepingCalcKill, no deeper iteration starts after the soft deadline
+            if (Context._VcxTasks.front().NextDepth > Context._VcxFirstDepth && IsSoftTimeUp(Context)) {
+                return;
+            }
+            Task = Context._VcxTasks.front();
+            Context._VcxTasks.pop();
+        }
+
+        // An interrupted solve can only come back empty, so any pawn returned here is a real proof
+        PutPawn(Worker, Task.Point);
+        Board::PawnInfo Reply = CalcVcxKill(Worker, Task.NextDepth - 1, bIsVct, 3 - _MachinePawn);
+        RevokePawn(Worker, Task.Point);
+        if (Reply.Type != Board::_kEmpty) {
+            std::lock_guard<std::mutex> Lock(Context._Mutex);
+            if (Context._VcxPoint.Type == Board::_kEmpty) {
+                Context._VcxPoint = Task.Point;
+            }
+            Context._bStopSearch = true;
+        }
+    }
+}
+
+int Evaluator::Minimax(SearchContext& Context, int CurrentDepth, int NextDepth, int Alpha, int Beta,
+                       Board::PawnType PawnType) const {
+    Context._Statistics.AddNode();
     if (NextDepth == 0) {
-        return EvalBoard();
+        Context._Statistics.AddLeafEvaluation();
+        return EvalBoard(Context);
+    }
+    CheckDeadline(Context);
+    if (Context._StopSignal->load(std::memory_order_relaxed)) {
+        return 0;
     }
 
-    bool bMachineFlag = PawnType == _MachinePawn;
+    bool bMachineFlag  = PawnType == _MachinePawn;
+    int  OriginalAlpha = Alpha;
+    int  OriginalBeta  = Beta;
 
-    LayoutCache Cache;
-    if (_HashCode != 0 && _Cache.find(_HashCode) != _Cache.end()) {
-        Cache = _Cache[_HashCode];
-        if (Cache.Depth >= NextDepth) {
-            return Cache.Score;
+    std::uint64_t             HashCode = Context._Board.GetHashCode();
+    TranspositionTable::Entry Entry;
+    bool bHasEntry = _TranspositionTable->Probe(HashCode, Entry);
+    if constexpr (SearchStatistics::kEnabled) {
+        Context._Statistics.AddTableProbe(bHasEntry, !bHasEntry && _TranspositionTable->IsBucketInUse(HashCode));
+    }
+    if (bHasEntry && CurrentDepth != 0 && Entry.Depth >= NextDepth) {
+        if (Entry.Bound == TranspositionTable::BoundType::kExact ||
+            (Entry.Bound == TranspositionTable::BoundType::kLower && Entry.Score >= Beta) ||
+            (Entry.Bound == TranspositionTable::BoundType::kUpper && Entry.Score <= Alpha)) {
+            Context._Statistics.AddTableCutoff();
+            return Entry.Score;
         }
     }
-    std::vector<Board::PawnInfo> Points = GeneratePoints(PawnType);
-    if (CurrentDepth == 0 && Points.size() == 1) {
-        _BestMove = Points.front();
-        return Points.front().Score;
+    MovePicker      Picker{ Context.GetPlyPoints(), bHasEntry ? Entry.BestMove : TranspositionTable::kNoMove };
+    Board::PawnInfo BestPoint{};
+    if (CurrentDepth == 0) {
+        // The root needs every move up front, a single one is played without searching
+        GeneratePickerPoints(Context, Picker, CurrentDepth, PawnType);
+        if (Picker.Points.Size() == 1) {
+            Context._BestMove = Picker.Points.Front();
+            return Picker.Points.Front().Score;
+        }
+        BestPoint = Picker.Points.Front();
     }
 
-    std::vector<Board::PawnInfo> BestPoints;
-    for (const auto& Point : Points) {
+    int BestIndex = -1;
+    std::size_t MoveIndex = 0;
+    Board::PawnInfo Point;
+    while (PickPoint(Context, Picker, CurrentDepth, PawnType, Point)) {
         int Score = 0;
         if (Point.Score >= GetScore(PawnLayout::kFiveLink)) {
             Score = bMachineFlag ? std::numeric_limits<int>::max() - 1 : std::numeric_limits<int>::min() + 1;
         } else {
-            PutPawn(Point);
-            Score = Minimax(CurrentDepth + 1, NextDepth - 1, Alpha, Beta, 3 - PawnType);
-            RevokePawn(Point);
+            // PVS: the first move gets the full window, the rest only have to be proven worse with a null window
+            PutPawn(Context, Point);
+            if (MoveIndex == 0) {
+                Score = Minimax(Context, CurrentDepth + 1, NextDepth - 1, Alpha, Beta, 3 - PawnType);
+            } else if (bMachineFlag) {
+                Score = Minimax(Context, CurrentDepth + 1, NextDepth - 1, Alpha, Alpha + 1, 3 - PawnType);
+                if (Score > Alpha && Score < Beta) {
+                    Score = Minimax(Context, CurrentDepth + 1, NextDepth - 1, Alpha, Beta, 3 - PawnType);
+                }
+            } else {
+                Score = Minimax(Context, CurrentDepth + 1, NextDepth - 1, Beta - 1, Beta, 3 - PawnType);
+                if (Score < Beta && Score > Alpha) {
+                    Score = Minimax(Context, CurrentDepth + 1, NextDepth - 1, Alpha, Beta, 3 - PawnType);
+                }
+            }
+            RevokePawn(Context, Point);
+            if (Context._StopSignal->load(std::memory_order_relaxed)) {
+                return 0;
+            }
         }
 
         if (bMachineFlag) {
             if (Score > Alpha) {
                 Alpha = Score;
-                if (CurrentDepth == 0) {
-                    BestPoints.clear();
-                }
-                BestPoints.push_back(Point);
+                BestIndex = Board::ToIndex(Point.Row, Point.Column);
+                BestPoint = Point;
             }
         } else {
             if (Score < Beta) {
                 Beta = Score;
+                BestIndex = Board::ToIndex(Point.Row, Point.Column);
             }
         }
 
         if (Alpha >= Beta) {
+            Context._Statistics.AddCutoff(MoveIndex);
+            RecordCutoff(Context, Point, CurrentDepth, NextDepth, PawnType);
             break;
         }
+        ++MoveIndex;
     }
 
     if (CurrentDepth == 0) {
-        _BestMove = BestPoints.size() > 1 ? GetBestPoint(Points) : BestPoints.front();
+        Context._BestMove = BestPoint;
     }
 
     int Result = bMachineFlag ? Alpha : Beta;
-    _Cache.insert({ _HashCode, LayoutCache(Result, NextDepth) });
+    TranspositionTable::BoundType Bound = TranspositionTable::BoundType::kExact;
+    if (Result <= OriginalAlpha) {
+        Bound = TranspositionTable::BoundType::kUpper;
+    } else if (Result >= OriginalBeta) {
+        Bound = TranspositionTable::BoundType::kLower;
+    }
+    _TranspositionTable->Store(HashCode, Result, NextDepth, Bound, BestIndex);
     return Result;
 }
 
-int Evaluator::Evaluate(Board::PawnInfo& Pawn) {
+int Evaluator::Evaluate(const SearchContext& Context, Board::PawnInfo& Pawn) const {
+    int Index = Board::ToIndex(Pawn.Row, Pawn.Column);
+#ifdef _DEBUG
+    for (int i = 0; i != 4; ++i) {
+        assert(Context._LineCache[Pawn.Type - 1][Index][i] == _Patterns.GetMatches(GetLineKey(Context._Board, Pawn, i)));
+    }
+#endif // _DEBUG
+
+    Pawn.Score = Context._ScoreCache[Pawn.Type - 1][Index];
+
+    return Pawn.Score;
+}
+
+int Evaluator::CalcScore(const LineMatches& Lines) const {
     int Score     = 0;
     int BlockFour = 0; // 冲四
     int Three     = 0; // 活三
     int FourThree = 0; // 冲四活三
-    std::string Situation;
-    for (int i = 0; i != 4; ++i) {
-        Situation = GetSituation(Pawn, i);
-        PawnLayout Layout = GetPawnLayout(Situation);
+    for (std::uint16_t Matches : Lines) {
+        PawnLayout Layout = PatternTable::GetLineLayout(Matches);
         if (Layout != PawnLayout::kEmpty) {
             switch (Layout) {
             case PawnLayout::kThree:
                 ++Three;
-                if (HasLayout(Situation, _kBlockFour)) {
+                if (Matches & PatternTable::GetLayoutMask(PawnLayout::kBlockFour)) {
                     ++FourThree;
                 }
                 break;
@@ -165,92 +370,278 @@ int Evaluator::Evaluate(Board::PawnInfo& Pawn) {
         Score += GetScore(PawnLayout::kMultiThree);
     }
 
-    Pawn.Score = Score;
-
     return Score;
 }
 
-std::vector<Board::PawnInfo> Evaluator::GeneratePoints(Board::PawnType PawnType) {
-    std::vector<Board::PawnInfo> KillPoints;
-    std::vector<Board::PawnInfo> HighPriorityPoints;
-    std::vector<Board::PawnInfo> MiddlePriorityPoints;
-    std::vector<Board::PawnInfo> LowPriorityPoints;
-    std::size_t MaxPointCount = 10;
-    int ThreatLevel = 0;
+// Refreshes the cells from FirstOffset to LastOffset along Direction from (Row, Column), all of them on the board,
+// with one kernel call for the whole run
+void Evaluator::RefreshLine(SearchContext& Context, int Row, int Column, int Direction, int FirstOffset, int LastOffset) const {
+    std::array<std::uint16_t, LineKernel::kMaxCells> BlackMatches;
+    std::array<std::uint16_t, LineKernel::kMaxCells> WhiteMatches;
+    auto [Line, Position] = Context._Board.GetLine(Row, Column, Direction);
+    _LineKernel.Classify(Line, Position + FirstOffset, LastOffset - FirstOffset + 1, BlackMatches.data(), WhiteMatches.data());
+
+    for (int Offset = FirstOffset; Offset <= LastOffset; ++Offset) {
+        int CellRow    = Row    + Offset * Board::_kRowSteps[Direction];
+        int CellColumn = Column + Offset * Board::_kColumnSteps[Direction];
+        int Index      = Board::ToIndex(CellRow, CellColumn);
+        Context._LineCache[0][Index][Direction] = BlackMatches[Offset - FirstOffset];
+        Context._LineCache[1][Index][Direction] = WhiteMatches[Offset - FirstOffset];
+#ifdef _DEBUG
+        for (Board::PawnType Type : { Board::_kBlack, Board::_kWhite }) {
+            Board::PawnInfo     Pawn{ CellRow, CellColumn, Type };
+            std::uint16_t       Matches   = Context._LineCache[Type - 1][Index][Direction];
+            std::array<char, 9> Situation = GetSituation(Context._Board, Pawn, Direction);
+            assert(Matches == _Patterns.GetMatches(GetLineKey(Context._Board, Pawn, Direction)));
+            assert(PatternTable::GetLineLayout(Matches) == PatternTable::GetPawnLayout({ Situation.data(), Situation.size() }));
+        }
+#endif // _DEBUG
+    }
+}
 
+// Full refresh with the scalar key of every cell, it runs once per search and is the reference RefreshLine is checked
+// against in debug builds
+void Evaluator::SyncCache(SearchContext& Context) const {
+    Context._PawnScores = { 0, 0 };
     for (int x = 0; x != kBoardSize; ++x) {
         for (int y = 0; y != kBoardSize; ++y) {
-            if (_Board->GetPawnsMap()[x][y] != Board::_kEmpty) {
-                continue;
+            int Index = Board::ToIndex(x, y);
+            for (int Direction = 0; Direction != 4; ++Direction) {
+                for (Board::PawnType Type : { Board::_kBlack, Board::_kWhite }) {
+                    Board::PawnInfo Pawn{ x, y, Type };
+                    Context._LineCache[Type - 1][Index][Direction] = _Patterns.GetMatches(GetLineKey(Context._Board, Pawn, Direction));
+                }
             }
+            Context._ScoreCache[0][Index] = CalcScore(Context._LineCache[0][Index]);
+            Context._ScoreCache[1][Index] = CalcScore(Context._LineCache[1][Index]);
 
-            Board::PawnInfo NewPoint{ x, y, PawnType };
-            int Score = Evaluate(NewPoint);
-            if (Score >= GetScore(PawnLayout::kFiveLink)) {
-                return { NewPoint };
+            Board::PawnType Type = Context._Board.GetPawn(x, y);
+            if (Type != Board::_kEmpty) {
+                Context._PawnScores[Type - 1] += Context._ScoreCache[Type - 1][Index];
             }
-            if (ThreatLevel == 2) {
-                continue;
+        }
+    }
+}
+
+void Evaluator::UpdateCache(SearchContext& Context, const Board::PawnInfo& Point) const {
+    // Only the windows crossing Point change, that is Point itself and the 8 neighbours on each of its 4 lines
+    for (int Direction = 0; Direction != 4; ++Direction) {
+        int FirstOffset = -4;
+        int LastOffset  = 4;
+        for (auto [Step, Coordinate] : { std::pair{ Board::_kRowSteps[Direction],    Point.Row },
+                                         std::pair{ Board::_kColumnSteps[Direction], Point.Column } }) {
+            if (Step > 0) {
+                FirstOffset = std::max(FirstOffset, -Coordinate);
+                LastOffset  = std::min(LastOffset, kBoardSize - 1 - Coordinate);
+            } else if (Step < 0) {
+                FirstOffset = std::max(FirstOffset, Coordinate - (kBoardSize - 1));
+                LastOffset  = std::min(LastOffset, Coordinate);
             }
-            if (Score >= GetScore(PawnLayout::kMiddleRisk)) {
-                KillPoints.push_back(NewPoint);
+        }
+
+        RefreshLine(Context, Point.Row, Point.Column, Direction, FirstOffset, LastOffset);
+        for (int Offset = FirstOffset; Offset <= LastOffset; ++Offset) {
+            if (Offset != 0) {
+                RescoreCell(Context, Point.Row + Offset * Board::_kRowSteps[Direction],
+                            Point.Column + Offset * Board::_kColumnSteps[Direction]);
             }
+        }
+    }
+
+    // Point.Type is the pawn being put or revoked, it enters or leaves the running sum here
+    int  Index   = Board::ToIndex(Point.Row, Point.Column);
+    int& Sum     = Context._PawnScores[Point.Type - 1];
+    bool bPlaced = Context._Board.GetPawn(Point.Row, Point.Column) != Board::_kEmpty;
+    if (!bPlaced) {
+        Sum -= Context._ScoreCache[Point.Type - 1][Index];
+    }
+    Context._ScoreCache[0][Index] = CalcScore(Context._LineCache[0][Index]);
+    Context._ScoreCache[1][Index] = CalcScore(Context._LineCache[1][Index]);
+    if (bPlaced) {
+        Sum += Context._ScoreCache[Point.Type - 1][Index];
+    }
+}
+
+void Evaluator::RescoreCell(SearchContext& Context, int Row, int Column) const {
+    int             Index = Board::ToIndex(Row, Column);
+    Board::PawnType Type  = Context._Board.GetPawn(Row, Column);
+    if (Type != Board::_kEmpty) {
+        Context._PawnScores[Type - 1] -= Context._ScoreCache[Type - 1][Index];
+    }
+    Context._ScoreCache[0][Index] = CalcScore(Context._LineCache[0][Index]);
+    Context._ScoreCache[1][Index] = CalcScore(Context._LineCache[1][Index]);
+    if (Type != Board::_kEmpty) {
+        Context._PawnScores[Type - 1] += Context._ScoreCache[Type - 1][Index];
+    }
+}
 
-            Board::PawnInfo FoePoint{ x, y, 3 - PawnType };
-            int FoeScore = Evaluate(FoePoint);
-            int CurrentThreatLevel = 0;
-            if (FoeScore >= GetScore(PawnLayout::kFiveLink)) {
-                CurrentThreatLevel = 2;
-            } else if (FoeScore >= GetScore(PawnLayout::kMiddleRisk)) {
-                CurrentThreatLevel = 1;
+// The hash move comes before anything is generated, a cutoff on it leaves the rest of the board unscored. It was
+// stored from GeneratePoints of the same position, so the generated moves skip it later rather than try it twice.
+// The generated moves are ordered in one pass: there are at most 10 of them unless some are winning, and picking them
+// one by one would see the history change under the loop
+bool Evaluator::PickPoint(SearchContext& Context, MovePicker& Picker, int CurrentDepth, Board::PawnType PawnType,
+                          Board::PawnInfo& Point) const {
+    switch (Picker.Stage) {
+    case PickStage::kHashMove:
+        Picker.Stage = PickStage::kGenerate;
+        if (Picker.HashMove != TranspositionTable::kNoMove && Context._Board.GetCandidates().Test(Picker.HashMove)) {
+            Point = { Picker.HashMove / kBoardSize, Picker.HashMove % kBoardSize, PawnType };
+            Evaluate(Context, Point);
+            Picker.bHashTried = true;
+            return true;
+        }
+        [[fallthrough]];
+    case PickStage::kGenerate:
+        GeneratePickerPoints(Context, Picker, CurrentDepth, PawnType);
+        [[fallthrough]];
+    case PickStage::kOrdered:
+        while (Picker.Next != Picker.Points.Size()) {
+            Point = Picker.Points[Picker.Next++];
+            if (!Picker.bHashTried || Board::ToIndex(Point.Row, Point.Column) != Picker.HashMove) {
+                return true;
             }
+        }
+        return false;
+    }
+    return false;
+}
 
-            if (CurrentThreatLevel > 0) {
-                if (ThreatLevel < CurrentThreatLevel) {
-                    ThreatLevel = CurrentThreatLevel;
-                    HighPriorityPoints.clear();
-                }
-                HighPriorityPoints.push_back(NewPoint);
+void Evaluator::GeneratePickerPoints(SearchContext& Context, MovePicker& Picker, int CurrentDepth,
+                                     Board::PawnType PawnType) const {
+    GeneratePoints(Context, PawnType, Picker.Points);
+    Context._Statistics.AddGeneration(Picker.Points.Size());
+    OrderPoints(Context, Picker.Points, CurrentDepth, PawnType, Picker.HashMove);
+    Picker.Stage = PickStage::kOrdered;
+}
+
+// Hash move first, then by static score. Killers of this ply and the history only break ties, moving them ahead of
+// stronger threats costs more nodes than it saves
+void Evaluator::OrderPoints(const SearchContext& Context, MoveList& Points, int CurrentDepth,
+                            Board::PawnType PawnType, int HashMove) const {
+    const auto& Killers = Context._Killers[std::min(CurrentDepth, SearchContext::_kMaxPly - 1)];
+    const auto& History = Context._History[PawnType - 1];
+    auto GetRank = [&](const Board::PawnInfo& Point) -> int {
+        int Index = Board::ToIndex(Point.Row, Point.Column);
+        if (Index == HashMove) {
+            return 0;
+        }
+        return Index == Killers[0] ? 1 : Index == Killers[1] ? 2 : 3;
+    };
+
+    Points.StableSort(
+        [&](const Board::PawnInfo& Point1, const Board::PawnInfo& Point2) -> bool {
+            int Rank1 = GetRank(Point1);
+            int Rank2 = GetRank(Point2);
+            if ((Rank1 == 0) != (Rank2 == 0)) {
+                return Rank1 == 0;
+            }
+            if (Point1.Score != Point2.Score) {
+                return Point1.Score > Point2.Score;
+            }
+            if (Rank1 != Rank2) {
+                return Rank1 < Rank2;
             }
+            return History[Board::ToIndex(Point1.Row, Point1.Column)] > History[Board::ToIndex(Point2.Row, Point2.Column)];
+        }
+    );
+}
 
-            if (ThreatLevel > 0) {
-                continue;
+void Evaluator::RecordCutoff(SearchContext& Context, const Board::PawnInfo& Point, int CurrentDepth, int NextDepth,
+                             Board::PawnType PawnType) const {
+    int Index = Board::ToIndex(Point.Row, Point.Column);
+    Context._History[PawnType - 1][Index] += NextDepth * NextDepth;
+
+    auto& Killers = Context._Killers[std::min(CurrentDepth, SearchContext::_kMaxPly - 1)];
+    if (Killers[0] != Index) {
+        Killers[1] = Killers[0];
+        Killers[0] = Index;
+    }
+}
+
+void Evaluator::GeneratePoints(SearchContext& Context, Board::PawnType PawnType, MoveList& Points) const {
+    MoveList& KillPoints           = Context._Buckets[0];
+    MoveList& HighPriorityPoints   = Context._Buckets[1];
+    MoveList& MiddlePriorityPoints = Context._Buckets[2];
+    MoveList& LowPriorityPoints    = Context._Buckets[3];
+    for (auto& Bucket : Context._Buckets) {
+        Bucket.Clear();
+    }
+    Points.Clear();
+    std::size_t MaxPointCount = 10;
+    int ThreatLevel = 0;
+
+    // Every pattern needs another pawn within 2 cells, farther cells score 0 for both sides and are never picked
+    for (int Index : Context._Board.GetCandidates()) {
+        int x = Index / kBoardSize;
+        int y = Index % kBoardSize;
+        Board::PawnInfo NewPoint{ x, y, PawnType };
+        int Score = Evaluate(Context, NewPoint);
+        if (Score >= GetScore(PawnLayout::kFiveLink)) {
+            Points.Push(NewPoint);
+            return;
+        }
+        if (ThreatLevel == 2) {
+            continue;
+        }
+        if (Score >= GetScore(PawnLayout::kMiddleRisk)) {
+            KillPoints.Push(NewPoint);
+        }
+
+        Board::PawnInfo FoePoint{ x, y, 3 - PawnType };
+        int FoeScore = Evaluate(Context, FoePoint);
+        int CurrentThreatLevel = 0;
+        if (FoeScore >= GetScore(PawnLayout::kFiveLink)) {
+            CurrentThreatLevel = 2;
+        } else if (FoeScore >= GetScore(PawnLayout::kMiddleRisk)) {
+            CurrentThreatLevel = 1;
+        }
+
+        if (CurrentThreatLevel > 0) {
+            if (ThreatLevel < CurrentThreatLevel) {
+                ThreatLevel = CurrentThreatLevel;
+                HighPriorityPoints.Clear();
             }
+            HighPriorityPoints.Push(NewPoint);
+        }
+
+        if (ThreatLevel > 0) {
+            continue;
+        }
 
-            if (ScoreBetween(Score,    PawnLayout::kLowRisk, PawnLayout::kMiddleRisk) ||
-                ScoreBetween(FoeScore, PawnLayout::kLowRisk, PawnLayout::kMiddleRisk)) {
-                HighPriorityPoints.push_back(NewPoint);
+        if (ScoreBetween(Score,    PawnLayout::kLowRisk, PawnLayout::kMiddleRisk) ||
+            ScoreBetween(FoeScore, PawnLayout::kLowRisk, PawnLayout::kMiddleRisk)) {
+            HighPriorityPoints.Push(NewPoint);
+            continue;
+        }
+
+        if (HighPriorityPoints.Empty()) {
+            if (Score >= GetScore(PawnLayout::kBlockFour) || FoeScore >= GetScore(PawnLayout::kBlockFour)) {
+                MiddlePriorityPoints.Push(NewPoint);
                 continue;
             }
-
-            if (HighPriorityPoints.empty()) {
-                if (Score >= GetScore(PawnLayout::kBlockFour) || FoeScore >= GetScore(PawnLayout::kBlockFour)) {
-                    MiddlePriorityPoints.push_back(NewPoint);
-                    continue;
-                }
-                if (MiddlePriorityPoints.empty() && Score >= GetScore(PawnLayout::kBlockOne)) {
-                    LowPriorityPoints.push_back(NewPoint);
-                }
+            if (MiddlePriorityPoints.Empty() && Score >= GetScore(PawnLayout::kBlockOne)) {
+                LowPriorityPoints.Push(NewPoint);
             }
         }
     }
 
-    if (ThreatLevel < 2 && !KillPoints.empty()) {
-        return KillPoints;
+    if (ThreatLevel < 2 && !KillPoints.Empty()) {
+        Points.Append(KillPoints);
+        return;
     }
 
-    std::vector<Board::PawnInfo> Points;
-    if (HighPriorityPoints.empty()) {
-        if (MiddlePriorityPoints.empty()) {
-            if (LowPriorityPoints.empty()) {
-                return GenRandomPoints(1);
+    if (HighPriorityPoints.Empty()) {
+        if (MiddlePriorityPoints.Empty()) {
+            if (LowPriorityPoints.Empty()) {
+                GenRandomPoints(Context, 1, Points);
+                return;
             }
-            Points = LowPriorityPoints;
+            Points.Append(LowPriorityPoints);
         } else {
-            Points = MiddlePriorityPoints;
+            Points.Append(MiddlePriorityPoints);
         }
     } else {
-        Points = HighPriorityPoints;
+        Points.Append(HighPriorityPoints);
     }
 
     std::sort(Points.begin(), Points.end(),
@@ -259,104 +650,99 @@ std::vector<Board::PawnInfo> Evaluator::GeneratePoints(Board::PawnType PawnType)
         }
     );
 
-    return std::vector<Board::PawnInfo>(Points.begin(), Points.begin() + std::min(MaxPointCount, Points.size()));
+    Points.Truncate(MaxPointCount);
 }
 
-std::vector<Board::PawnInfo> Evaluator::FindVcxPoints(Board::PawnType PawnType, bool bIsVct) {
-    std::vector<Board::PawnInfo> AttackPoints;
-    std::vector<Board::PawnInfo> DefensePoints;
-    std::vector<Board::PawnInfo> VcxPoints;
+void Evaluator::FindVcxPoints(SearchContext& Context, Board::PawnType PawnType, bool bIsVct, MoveList& Points) const {
+    MoveList& AttackPoints  = Context._Buckets[0];
+    MoveList& DefensePoints = Context._Buckets[1];
+    MoveList& VcxPoints     = Context._Buckets[2];
+    AttackPoints.Clear();
+    DefensePoints.Clear();
+    VcxPoints.Clear();
+    Points.Clear();
     bool bMachineFlag = PawnType == _MachinePawn;
     bool bHasThreat   = false;
-    for (int x = 0; x != kBoardSize; ++x) {
-        for (int y = 0; y != kBoardSize; ++y) {
-            if (_Board->GetPawnsMap()[x][y] != Board::_kEmpty) {
-                continue;
-            }
 
-            Board::PawnInfo NewPoint{ x, y, PawnType };
-            int Score = Evaluate(NewPoint);
-            if (Score >= GetScore(PawnLayout::kFiveLink)) {
-                return { NewPoint };
-            }
-            if (bHasThreat) {
-                continue;
-            }
+    // The defender of a VCT only answers on the cost squares of the attacker's threes, or with a four of its own
+    BitBoard Defenses;
+    if (!bMachineFlag && bIsVct) {
+        _ThreatSpace.FindDefenses(Context._Board, 3 - PawnType, Defenses);
+    }
 
-            Board::PawnInfo FoePoint{ x, y, 3 - PawnType };
-            int FoeScore = Evaluate(FoePoint);
-            if (FoeScore >= GetScore(PawnLayout::kFiveLink)) {
-                bHasThreat = true;
-                DefensePoints.clear();
-                DefensePoints.push_back(NewPoint);
-                continue;
-            }
+    for (int Index : Context._Board.GetCandidates()) {
+        int x = Index / kBoardSize;
+        int y = Index % kBoardSize;
+        Board::PawnInfo NewPoint{ x, y, PawnType };
+        int Score = Evaluate(Context, NewPoint);
+        if (Score >= GetScore(PawnLayout::kFiveLink)) {
+            Points.Push(NewPoint);
+            return;
+        }
+        if (bHasThreat) {
+            continue;
+        }
 
-            if (Score >= GetScore(PawnLayout::kMiddleRisk)) {
-                AttackPoints.push_back(NewPoint);
-                continue;
-            }
+        Board::PawnInfo FoePoint{ x, y, 3 - PawnType };
+        int FoeScore = Evaluate(Context, FoePoint);
+        if (FoeScore >= GetScore(PawnLayout::kFiveLink)) {
+            bHasThreat = true;
+            DefensePoints.Clear();
+            DefensePoints.Push(NewPoint);
+            continue;
+        }
 
-            if (bMachineFlag) {
-                if (HasLayoutNearPawn(NewPoint, _kBlockFour)) {
-                    VcxPoints.push_back(NewPoint);
-                } else if (bIsVct && HasLayoutNearPawn(NewPoint, _kThree)) {
-                    VcxPoints.push_back(NewPoint);
-                }
-            } else {
-                if (bIsVct) {
-                    if (HasLayoutNearPawn(NewPoint, _kBlockFour) || FoeScore >= GetScore(PawnLayout::kFour)) {
-                        DefensePoints.push_back(NewPoint);
-                    }
-                }
+        if (Score >= GetScore(PawnLayout::kMiddleRisk)) {
+            AttackPoints.Push(NewPoint);
+            continue;
+        }
+
+        ThreatSpace::ThreatType Threat = _ThreatSpace.GetThreat(Context._Board, Index, PawnType);
+        if (bMachineFlag) {
+            if (Threat >= (bIsVct ? ThreatSpace::ThreatType::kThree : ThreatSpace::ThreatType::kFour)) {
+                VcxPoints.Push(NewPoint);
+            }
+        } else {
+            if (bIsVct && (Defenses.Test(Index) || Threat >= ThreatSpace::ThreatType::kFour)) {
+                DefensePoints.Push(NewPoint);
             }
         }
     }
 
-    std::vector<Board::PawnInfo> Points;
+    // The defender's answers to the attacker's threats come first
+    if (!bMachineFlag) {
+        Points.Append(DefensePoints);
+    }
     if (!bHasThreat) {
-        if (!AttackPoints.empty()) {
+        if (!AttackPoints.Empty()) {
             std::sort(AttackPoints.begin(), AttackPoints.end(),
                 [this](const Board::PawnInfo& Point1, const Board::PawnInfo& Point2) -> bool {
                     return Point1.Score > Point2.Score;
                 }
             );
+            Points.Append(AttackPoints);
             if (bMachineFlag) {
-                return AttackPoints;
+                return;
             }
-
-            Points.insert(Points.end(), AttackPoints.begin(), AttackPoints.end());
         }
 
-        if (!VcxPoints.empty()) {
-            Points.insert(Points.end(), VcxPoints.begin(), VcxPoints.end());
-        }
+        Points.Append(VcxPoints);
     }
 
-    if (!DefensePoints.empty()) {
-        if (bMachineFlag) {
-            Points.insert(Points.end(), DefensePoints.begin(), DefensePoints.end());
-        } else {
-            Points.insert(Points.begin(), DefensePoints.begin(), DefensePoints.end());
-        }
+    if (bMachineFlag) {
+        Points.Append(DefensePoints);
     }
-
-    return Points;
 }
 
-std::string Evaluator::GetSituation(const Board::PawnInfo& Pawn, int Direction) {
-    std::string Line;
+std::array<char, 9> Evaluator::GetSituation(const Board& Target, const Board::PawnInfo& Pawn, int Direction) const {
+    std::array<char, 9> Line{};
     for (int Offset = -4; Offset <= 4; ++Offset) {
-        if (Offset == 0) {
-            Line.push_back('X');
-        } else {
-            Line.push_back(GetPawn(Pawn, Direction, Offset));
-        }
+        Line[Offset + 4] = Offset == 0 ? 'X' : GetPawn(Target, Pawn, Direction, Offset);
     }
     return Line;
 }
 
-char Evaluator::GetPawn(const Board::PawnInfo& Pawn, int Direction, int Offset) {
+char Evaluator::GetPawn(const Board& Target, const Board::PawnInfo& Pawn, int Direction, int Offset) const {
     int Row    = Pawn.Row;
     int Column = Pawn.Column;
 
@@ -381,7 +767,7 @@ char Evaluator::GetPawn(const Board::PawnInfo& Pawn, int Direction, int Offset)
         return '-';
     }
 
-    int CurrentPawn = _Board->GetPawnsMap()[Row][Column];
+    int CurrentPawn = Target.GetPawn(Row, Column);
 
     if (CurrentPawn == Board::_kEmpty) {
         return '_';
@@ -393,91 +779,91 @@ char Evaluator::GetPawn(const Board::PawnInfo& Pawn, int Direction, int Offset)
     }
 }
 
-Evaluator::PawnLayout Evaluator::GetPawnLayout(const std::string_view Str) {
-    for (const auto& ScorePair : _ScoreMap) {
-        if (HasLayout(Str, ScorePair.first)) {
-            return ScorePair.second;
-        }
-    }
-
-    return PawnLayout::kEmpty;
-}
-
-bool Evaluator::HasLayout(const std::string_view Str, const std::vector<std::string>& Layout) {
-    for (const auto& Pattern : Layout) {
-        if (Str.contains(Pattern)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Evaluator::HasLayoutNearPawn(const Board::PawnInfo& Pawn, const std::vector<std::string>& Layout) {
+bool Evaluator::HasLayoutNearPawn(const Board& Target, const Board::PawnInfo& Pawn, PawnLayout Layout) const {
+    std::uint16_t Mask = PatternTable::GetLayoutMask(Layout);
     for (int i = 0; i != 4; ++i) {
-        if (HasLayout(GetSituation(Pawn, i), Layout)) {
+        if (_Patterns.GetMatches(GetLineKey(Target, Pawn, i)) & Mask) {
             return true;
         }
     }
     return false;
 }
 
-int Evaluator::EvalBoard() {
-    int HumanScore   = 0;
-    int MachineScore = 0;
-    for (int x = 0; x != kBoardSize; ++x) {
-        for (int y = 0; y != kBoardSize; ++y) {
-            if (_Board->GetPawnsMap()[x][y] == Board::_kEmpty) {
-                continue;
-            }
-            Board::PawnType CurrentType = _Board->GetPawnsMap()[x][y];
-            bool bMachineFlag = false;
-            if (CurrentType == _MachinePawn) {
-                bMachineFlag = true;
+int Evaluator::EvalBoard(const SearchContext& Context) const {
+    int HumanScore   = Context._PawnScores[2 - _MachinePawn];
+    int MachineScore = Context._PawnScores[_MachinePawn - 1];
+
+#ifdef _DEBUG
+    // Scores rebuilt from fresh line keys, independent of the line and score caches they are checked against
+    int FullHumanScore   = 0;
+    int FullMachineScore = 0;
+    for (Board::PawnType CurrentType : { Board::_kBlack, Board::_kWhite }) {
+        bool bMachineFlag = CurrentType == _MachinePawn;
+        for (int Index : Context._Board.GetPawns(CurrentType)) {
+            Board::PawnInfo Pawn{ Index / kBoardSize, Index % kBoardSize, CurrentType };
+            LineMatches     Lines;
+            for (int Direction = 0; Direction != 4; ++Direction) {
+                Lines[Direction] = _Patterns.GetMatches(GetLineKey(Context._Board, Pawn, Direction));
             }
-            Board::PawnInfo Pawn{ x, y, CurrentType };
-            int Score = Evaluate(Pawn);
+            int Score = CalcScore(Lines);
+            assert(Score == Context._ScoreCache[CurrentType - 1][Index]);
             if (bMachineFlag) {
-                MachineScore += Score;
+                FullMachineScore += Score;
             } else {
-                HumanScore   += Score;
+                FullHumanScore   += Score;
             }
         }
     }
+    assert(FullHumanScore == HumanScore && FullMachineScore == MachineScore);
+#endif // _DEBUG
 
     return MachineScore * _Aggressiveness - HumanScore;
 }
 
-Board::PawnInfo Evaluator::CalcVcxKill(int NextDepth, bool bIsVct, Board::PawnType PawnType) {
+Board::PawnInfo Evaluator::CalcVcxKill(SearchContext& Context, int NextDepth, bool bIsVct, Board::PawnType PawnType) const {
     if (NextDepth == 0) {
         return {};
     }
+    Context._Statistics.AddVcxNode();
+    CheckDeadline(Context);
+    if (Context._StopSignal->load(std::memory_order_relaxed)) {
+        return {};
+    }
 
     bool bMachineFlag = PawnType == _MachinePawn;
 
-    LayoutCache Cache;
-    if (_HashCode != 0 && _Cache.find(_HashCode) != _Cache.end()) {
-        Cache = _Cache[_HashCode];
-        if (Cache.Depth >= NextDepth) {
-            return Cache.VcxPoint;
+    std::uint64_t     ProofKey = GetProofKey(Context, bIsVct, PawnType);
+    ProofTable::Entry Proof;
+    if (Context._SharedProofTable->Probe(ProofKey, Proof)) {
+        if (Proof.Result == ProofTable::ProofResult::kWin && Proof.Depth <= NextDepth) {
+            return { Proof.Move / kBoardSize, Proof.Move % kBoardSize, PawnType };
+        }
+        if (Proof.Result == ProofTable::ProofResult::kNoWin && Proof.Depth >= NextDepth) {
+            return {};
         }
     }
 
     Board::PawnInfo BestVcxPawn{};
-    std::vector<Board::PawnInfo> Points = FindVcxPoints(PawnType, bIsVct);
+    MoveList& Points = Context.GetPlyPoints();
+    FindVcxPoints(Context, PawnType, bIsVct, Points);
     for (const auto& Point : Points) {
         if (Point.Score >= GetScore(PawnLayout::kHighRisk)) {
             return bMachineFlag ? Point : Board::PawnInfo{};
         }
 
-        _Board->PutPawn(Point, true, false);
-        BestVcxPawn = CalcVcxKill(NextDepth - 1, bIsVct, 3 - PawnType);
-        _Board->PutPawn({ Point.Row, Point.Column, Board::_kEmpty }, true, false);
+        PutPawn(Context, Point);
+        BestVcxPawn = CalcVcxKill(Context, NextDepth - 1, bIsVct, 3 - PawnType);
+        RevokePawn(Context, Point);
+        if (Context._StopSignal->load(std::memory_order_relaxed)) {
+            return {};
+        }
 
         if (BestVcxPawn.Type == Board::_kEmpty) {
             if (bMachineFlag) {
                 continue;
             }
 
+            Context._SharedProofTable->Store(ProofKey, ProofTable::ProofResult::kNoWin, NextDepth, -1);
             return {};
         }
 
@@ -487,64 +873,205 @@ Board::PawnInfo Evaluator::CalcVcxKill(int NextDepth, bool bIsVct, Board::PawnTy
         }
     }
 
-    _Cache.insert({ _HashCode, LayoutCache(BestVcxPawn, NextDepth) });
+    if (BestVcxPawn.Type == Board::_kEmpty) {
+        Context._SharedProofTable->Store(ProofKey, ProofTable::ProofResult::kNoWin, NextDepth, -1);
+    } else {
+        Context._SharedProofTable->Store(ProofKey, ProofTable::ProofResult::kWin, NextDepth, Board::ToIndex(BestVcxPawn.Row, BestVcxPawn.Column));
+    }
 
     return BestVcxPawn;
 }
 
-Board::PawnInfo Evaluator::GetBestPoint(std::vector<Board::PawnInfo>& Points) {
-    Board::PawnInfo BestPoint{};
-    int BestScore = std::numeric_limits<int>::min();
+void Evaluator::GenRandomPoints(SearchContext& Context, std::size_t Amount, MoveList& Points) const {
+    Points.Clear();
+    for (int Index : Context._Board.GetPawns(Board::_kEmpty)) {
+        Points.Push({ Index / kBoardSize, Index % kBoardSize, _MachinePawn });
+    }
 
-    for (auto& Point : Points) {
-        Board::PawnInfo FoePoint = { Point.Row, Point.Column, 3 - Point.Type };
-        int Score = std::round(Evaluate(Point) * _Aggressiveness) + Evaluate(FoePoint);
-        if (Score > BestScore) {
-            BestScore = Score;
-            BestPoint = Point;
-        }
+    // Plain Fisher-Yates, std::shuffle may draw differently on another standard library
+    for (std::size_t i = Points.Size(); i > 1; --i) {
+        std::swap(Points[i - 1], Points[Context._RandomEngine() % i]);
     }
 
-    return BestPoint;
+    Points.Truncate(Amount);
 }
 
-std::vector<Board::PawnInfo> Evaluator::GenRandomPoints(std::size_t Amount) {
-    std::vector<Board::PawnInfo> Points;
-    for (int x = 0; x != kBoardSize; ++x) {
-        for (int y = 0; y != kBoardSize; ++y) {
-            if (_Board->GetPawnsMap()[x][y] == 0) {
-                Points.push_back({ x, y, _MachinePawn });
-            }
-        }
+Board::PawnInfo Evaluator::DeepingCalcKill(SearchContext& Context, int NextDepth, int MaxDepth, bool bIsVct) const {
+    if (!Context._Helpers.empty()) {
+        return ParallelCalcKill(Context, NextDepth, MaxDepth, bIsVct);
     }
 
-    std::mt19937 Engine(std::random_device{}());
-    std::shuffle(Points.begin(), Points.end(), Engine);
-
-    return std::vector<Board::PawnInfo>(Points.begin(), Points.begin() + std::min(Amount, Points.size()));
-}
-
-Board::PawnInfo Evaluator::DeepingCalcKill(int NextDepth, int MaxDepth, bool bIsVct) {
     Board::PawnInfo VcxPoint{};
     while (NextDepth <= MaxDepth) {
-        VcxPoint = CalcVcxKill(NextDepth, bIsVct, _MachinePawn);
-        if (VcxPoint.Type != Board::_kEmpty) {
+        VcxPoint = CalcVcxKill(Context, NextDepth, bIsVct, _MachinePawn);
+        if (VcxPoint.Type != Board::_kEmpty || Context._bStopSearch || IsSoftTimeUp(Context)) {
             break;
         }
 
         NextDepth += 2;
     }
+    Context._bStopSearch = false;
 
     return VcxPoint;
 }
 
-void Evaluator::DeepingMinimax(int NextDepth, int MaxDepth) {
-    while (NextDepth <= MaxDepth) {
-        int Score = Minimax(0, NextDepth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), _MachinePawn);
-        if (std::abs(Score) >= GetScore(PawnLayout::kFiveLink)) {
+Board::PawnInfo Evaluator::SolveProofNumbers(SearchContext& Context, bool bIsVct, std::size_t MaxNodes) const {
+    std::size_t NodeLimit = Context._NodeLimit;
+    Context._NodeLimit = std::min(Context._NodeLimit, Context._NodeCount + (MaxNodes > 0 ? MaxNodes : kDefaultVcxNodes));
+    ProofNumberTable::Entry Root = SearchProofNumbers(Context, bIsVct, _MachinePawn,
+                                                      ProofNumberTable::kInfinity, ProofNumberTable::kInfinity);
+    Context._NodeLimit   = NodeLimit;
+    Context._bStopSearch = false;
+
+    if (Root.ProofNumber != 0 || Root.Move == ProofNumberTable::kNoMove) {
+        return {};
+    }
+    return { Root.Move / kBoardSize, Root.Move % kBoardSize, _MachinePawn };
+}
+
+// df-pn: expands the node until its proof number reaches ProofThreshold or its disproof number DisproofThreshold.
+// Numbers are from the machine's view, 0 proof number is a forced win. The machine's nodes take the minimum proof
+// number of their children and the sum of the disproof numbers, the opponent's nodes the other way round
+ProofNumberTable::Entry Evaluator::SearchProofNumbers(SearchContext& Context, bool bIsVct, Board::PawnType PawnType,
+                                                      std::uint32_t ProofThreshold, std::uint32_t DisproofThreshold) const {
+    constexpr std::uint32_t kInfinity = ProofNumberTable::kInfinity;
+
+    ProofNumberTable::Entry Node;
+    Node.Key = GetProofKey(Context, bIsVct, PawnType);
+
+    Context._Statistics.AddVcxNode();
+    CheckDeadline(Context);
+    if (Context._StopSignal->load(std::memory_order_relaxed)) {
+        return Node;
+    }
+
+    bool        bMachineFlag = PawnType == _MachinePawn;
+    std::size_t FirstNode    = Context._NodeCount;
+
+    MoveList& Points = Context.GetPlyPoints();
+    FindVcxPoints(Context, PawnType, bIsVct, Points);
+    auto WinningPoint = std::find_if(Points.begin(), Points.end(),
+        [this](const Board::PawnInfo& Point) -> bool {
+            return Point.Score >= GetScore(PawnLayout::kHighRisk);
+        }
+    );
+    if (Points.Empty() || WinningPoint != Points.end()) {
+        // Without a threat to answer the attack has stopped, and a winning reply of the defender refutes it
+        bool bProven = bMachineFlag && WinningPoint != Points.end();
+        Node.ProofNumber    = bProven ? 0 : kInfinity;
+        Node.DisproofNumber = bProven ? kInfinity : 0;
+        Node.Work           = 1;
+        if (bProven) {
+            Node.Move = static_cast<std::uint8_t>(Board::ToIndex(WinningPoint->Row, WinningPoint->Column));
+        }
+        Context._ProofNumberTable->Store(Node);
+        return Node;
+    }
+
+    while (true) {
+        // The machine minimizes proof numbers and sums disproof numbers, the opponent the other way round
+        std::size_t   BestIndex  = 0;
+        std::uint32_t BestMin    = kInfinity;
+        std::uint32_t SecondMin  = kInfinity;
+        std::uint32_t BestSum    = 0;
+        std::uint32_t SumNumbers = 0;
+        for (std::size_t i = 0; i != Points.Size(); ++i) {
+            int                     ChildIndex = Board::ToIndex(Points[i].Row, Points[i].Column);
+            std::uint64_t           ChildHash  = Context._Board.GetHashCode() ^ Board::GetZobrist(ChildIndex, PawnType);
+            ProofNumberTable::Entry Child;
+            Context._ProofNumberTable->Probe(GetProofKey(ChildHash, bIsVct, 3 - PawnType), Child);
+            std::uint32_t MinNumber = bMachineFlag ? Child.ProofNumber    : Child.DisproofNumber;
+            std::uint32_t SumNumber = bMachineFlag ? Child.DisproofNumber : Child.ProofNumber;
+            if (MinNumber < BestMin) {
+                SecondMin = BestMin;
+                BestMin   = MinNumber;
+                BestSum   = SumNumber;
+                BestIndex = i;
+            } else if (MinNumber < SecondMin) {
+                SecondMin = MinNumber;
+            }
+            SumNumbers = std::min(SumNumbers + SumNumber, kInfinity);
+        }
+
+        Node.ProofNumber    = bMachineFlag ? BestMin : SumNumbers;
+        Node.DisproofNumber = bMachineFlag ? SumNumbers : BestMin;
+        Node.Move           = static_cast<std::uint8_t>(Board::ToIndex(Points[BestIndex].Row, Points[BestIndex].Column));
+        if (Node.ProofNumber >= ProofThreshold || Node.DisproofNumber >= DisproofThreshold) {
+            break;
+        }
+
+        // The child is searched until it alone pushes this node past its threshold, or until it is a quarter worse than
+        // the second best one; the margin keeps the search from switching back and forth between close siblings
+        std::uint32_t MinThreshold = bMachineFlag ? ProofThreshold : DisproofThreshold;
+        std::uint32_t SumThreshold = bMachineFlag ? DisproofThreshold : ProofThreshold;
+        std::uint32_t ChildMin     = std::min(MinThreshold, SecondMin + SecondMin / 4 + 1);
+        std::uint32_t ChildSum     = SumThreshold - SumNumbers + BestSum;
+
+        PutPawn(Context, Points[BestIndex]);
+        SearchProofNumbers(Context, bIsVct, 3 - PawnType, bMachineFlag ? ChildMin : ChildSum, bMachineFlag ? ChildSum : ChildMin);
+        RevokePawn(Context, Points[BestIndex]);
+        if (Context._StopSignal->load(std::memory_order_relaxed)) {
+            return Node;
+        }
+    }
+
+    Node.Work = static_cast<std::uint32_t>(
+        std::clamp<std::size_t>(Context._NodeCount - FirstNode, 1, std::numeric_limits<std::uint32_t>::max()));
+    Context._ProofNumberTable->Store(Node);
+    return Node;
+}
+
+Board::PawnInfo Evaluator::ParallelCalcKill(SearchContext& Context, int NextDepth, int MaxDepth, bool bIsVct) const {
+    MoveList& Points = Context.GetPlyPoints();
+    FindVcxPoints(Context, _MachinePawn, bIsVct, Points);
+    for (const auto& Point : Points) {
+        if (Point.Score >= GetScore(PawnLayout::kHighRisk)) {
+            return Point;
+        }
+    }
+
+    // Every root attack at every depth is a separate task, shallower ones first, and the first proof cancels the rest.
+    // The threads share the proof table, so a deeper task builds on the shallower proofs whichever thread made them
+    Context._VcxPoint = {};
+    Context._VcxTasks = {};
+    for (; NextDepth <= MaxDepth; NextDepth += 2) {
+        if (NextDepth <= 0) {
+            continue;
+        }
+        for (const auto& Point : Points) {
+            Context._VcxTasks.push({ Point, NextDepth });
+        }
+    }
+    Context._VcxFirstDepth = Context._VcxTasks.empty() ? 0 : Context._VcxTasks.front().NextDepth;
+
+    StartHelpers(Context, HelperTask::kCalcKill, MaxDepth, bIsVct);
+    ProcessVcxTasks(Context, Context, bIsVct);
+    WaitHelpers(Context);
+    Context._bStopSearch = false;
+
+    return Context._VcxPoint;
+}
+
+void Evaluator::DeepingMinimax(SearchContext& Context, int NextDepth, int MaxDepth) const {
+    // An aborted iteration never reaches the root update, so _BestMove is always from the last completed one
+    while (NextDepth <= MaxDepth && !Context._StopSignal->load(std::memory_order_relaxed)) {
+        auto BeginTime = std::chrono::steady_clock::now();
+        int  Score     = Minimax(Context, 0, NextDepth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), _MachinePawn);
+        if constexpr (SearchStatistics::kEnabled) {
+            Context._Statistics.AddIteration(NextDepth, std::chrono::duration<double>(std::chrono::steady_clock::now() - BeginTime).count());
+        }
+        if (std::abs(Score) >= GetScore(PawnLayout::kFiveLink) || IsSoftTimeUp(Context)) {
             break;
         }
 
         NextDepth += 2;
     }
+
+    if (Context._BestMove.Type == Board::_kEmpty) {
+        MoveList& Points = Context.GetPlyPoints();
+        GeneratePoints(Context, _MachinePawn, Points);
+        if (!Points.Empty()) {
+            Context._BestMove = Points.Front();
+        }
+    }
 }
@@ -1,84 +1,153 @@
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
-#include <mutex>
-#include <unordered_map>
-#include <queue>
-#include <string>
-#include <thread>
-#include <vector>
 
 #include "Board.h"
-
+#include "LineKernel.h"
+#include "MoveList.h"
+#include "PatternTable.h"
+#include "ProofNumberTable.h"
+#include "SearchContext.h"
+#include "SearchStatistics.h"
+#include "ThreatSpace.h"
+#include "TranspositionTable.h"
+
+// Search configuration and the transposition table. All search state lives in a SearchContext, so the const search
+// entry point can run from several threads at once, one context each
 class Evaluator {
+    friend class Benchmark;
+    friend class SearchContext;
+
 private:
-    enum class PawnLayout : int {
-        kFiveLink   = 10000000, // 连五
-        kFour       = 1000000,  // 活四
-        kMultiFour  = 800000,   // 多冲四
-        kFourThree  = 500000,   // 冲四活三
-        kMultiThree = 100000,   // 多活三
-        kThree      = 10000,    // 活三
-        kBlockFour  = 9000,     // 冲四
-        kTwo        = 100,      // 活二
-        kOne        = 80,       // 活一
-        kBlockThree = 30,       // 眠三
-        kBlockTwo   = 10,       // 眠二
-        kBlockOne   = 1,        // 眠一
-        kEmpty      = 0,
-
-        kHighRisk   = kMultiFour,
-        kMiddleRisk = kFourThree,
-        kLowRisk    = kMultiThree
+    using PawnLayout  = PatternTable::PawnLayout;
+    using LineMatches = SearchContext::LineMatches;
+    using HelperTask  = SearchContext::HelperTask;
+
+    enum class PickStage {
+        kHashMove, kGenerate, kOrdered
     };
 
-    struct LayoutCache {
-    public:
-        LayoutCache() = default;
-        LayoutCache(int Score, int Depth) : Score(Score), Depth(Depth) {}
-        LayoutCache(const Board::PawnInfo& VcxPoint, int Depth) : VcxPoint(VcxPoint), Depth(Depth) {}
+    // Moves of one Minimax node in search order, see PickPoint
+    struct MovePicker {
+        MoveList&   Points;
+        int         HashMove;
+        PickStage   Stage      = PickStage::kHashMove;
+        std::size_t Next       = 0;
+        bool        bHashTried = false;
+    };
 
-    public:
-        Board::PawnInfo VcxPoint;
-        int Score = 0;
-        int Depth = 0;
+public:
+    // kDeepening re-runs a depth limited DFS up to MaxVcxDepth, kProofNumber runs df-pn without a depth limit
+    enum class VcxSolver {
+        kDeepening, kProofNumber
+    };
+
+    // Table entries can be evicted and searched again, so df-pn always runs on a node budget
+    static constexpr std::size_t kDefaultVcxNodes = 100000;
+
+    // A zero limit means no limit, the search then stops at the depth limits only.
+    // Node limits count the main thread alone and keep a single threaded search reproducible, time limits do not
+    struct SearchLimits {
+        int                       MaxDepth         = 12;
+        bool                      bProcessCalcKill = false;
+        int                       MaxVcxDepth      = 0;
+        bool                      bIsVct           = false;
+        int                       NextVcxDepth     = 0;
+        VcxSolver                 Solver           = VcxSolver::kDeepening;
+        std::size_t               MaxVcxNodes      = kDefaultVcxNodes; // df-pn nodes before the solver gives up, 0 is the default
+        std::chrono::milliseconds SoftTime{ 0 };  // no new iteration starts after it
+        std::chrono::milliseconds HardTime{ 0 };  // running iterations are aborted at it
+        std::size_t               NodeLimit = 0;  // Minimax and VCF/VCT nodes before the search is aborted
     };
 
 public:
-    Evaluator(std::shared_ptr<Board> Board, Board::PawnType PawnType, double Aggressiveness);
+    // ThreadCount - 1 helper threads search the same root as the own context, sharing the transposition table.
+    // ProofTableSizeInMB sizes the proof tables of the own context, see SearchContext
+    Evaluator(std::shared_ptr<Board> Board, Board::PawnType PawnType, double Aggressiveness,
+              std::size_t TableSizeInMB = 16, std::size_t ThreadCount = 1,
+              std::size_t ProofTableSizeInMB = SearchContext::kDefaultProofTableSizeInMB);
     Evaluator(const Evaluator&) = delete;
 
-    bool IsGameOver(const Board::PawnInfo& LatestPawn);
-    Board::PawnInfo GetBestMove(int MaxDepth, bool bProcessCalcKill = false, int MaxVcxDepth = 0, bool bIsVct = false, int NextDepth = 0);
+    bool IsGameOver(const Board::PawnInfo& LatestPawn) const;
+    // Seeds the random move choices of the own context, see SearchContext::SetSeed
+    void SetSeed(std::uint64_t Seed);
+    // Makes the move lists of the own context up front, see SearchContext::ReserveMoveLists
+    void ReserveMoveLists();
+    // Searches the board given at construction with the own context
+    Board::PawnInfo GetBestMove(const SearchLimits& Limits);
+    // Searches the position of Context, which may run at the same time as other contexts' searches
+    Board::PawnInfo GetBestMove(SearchContext& Context, const SearchLimits& Limits) const;
+
+    // Transposition and proof tables, by far the largest part of an Evaluator
+    std::size_t GetTableSizeInBytes() const {
+        return _TranspositionTable->GetSizeInBytes() + _Context->GetTableSizeInBytes();
+    }
+
+    // The tables together with the own context and its buffers
+    std::size_t GetSizeInBytes() const {
+        return _TranspositionTable->GetSizeInBytes() + _Context->GetSizeInBytes();
+    }
+
+    // VCF/VCT win found by the last GetBestMove call on the own context, Type is empty if the move came from Minimax
+    const Board::PawnInfo& GetKillMove() const {
+        return _Context->_KillMove;
+    }
+
+    // Statistics of the last GetBestMove call on the own context
+    const SearchStatistics& GetStatistics() const {
+        return _Context->GetStatistics();
+    }
 
 private:
-    int Minimax(int CurrentDepth, int NextDepth, int Alpha, int Beta, Board::PawnType PawnType);
-    int Evaluate(Board::PawnInfo& Pawn);
-    std::vector<Board::PawnInfo> GeneratePoints(Board::PawnType PawnType);
-    std::vector<Board::PawnInfo> FindVcxPoints(Board::PawnType PawnType, bool bIsVct);
-    std::string GetSituation(const Board::PawnInfo& Pawn, int Direction);
-    char GetPawn(const Board::PawnInfo& Pawn, int Direction, int Offset);
-    PawnLayout GetPawnLayout(const std::string_view Str);
-    bool HasLayout(const std::string_view Str, const std::vector<std::string>& Layout);
-    bool HasLayoutNearPawn(const Board::PawnInfo& Pawn, const std::vector<std::string>& Layout);
-    int EvalBoard();
-    Board::PawnInfo CalcVcxKill(int NextDepth, bool bIsVct, Board::PawnType PawnType);
-    Board::PawnInfo GetBestPoint(std::vector<Board::PawnInfo>& Points);
-    std::vector<Board::PawnInfo> GenRandomPoints(std::size_t Amount);
-    Board::PawnInfo DeepingCalcKill(int NextDepth, int MaxDepth, bool bIsVct);
-    void DeepingMinimax(int NextDepth, int MaxDepth);
+    void StartHelpers(SearchContext& Context, HelperTask Task, int MaxDepth, bool bIsVct) const;
+    void StopHelpers(SearchContext& Context) const;
+    void WaitHelpers(SearchContext& Context) const;
+    void HelperLoop(SearchContext& Context, std::size_t Index) const;
+    void ProcessVcxTasks(SearchContext& Context, SearchContext& Worker, bool bIsVct) const;
+    Board::PawnInfo ParallelCalcKill(SearchContext& Context, int NextDepth, int MaxDepth, bool bIsVct) const;
+    Board::PawnInfo SearchBestMove(SearchContext& Context, const SearchLimits& Limits) const;
+    Board::PawnInfo FindForcedMove(const SearchContext& Context) const;
+    int Minimax(SearchContext& Context, int CurrentDepth, int NextDepth, int Alpha, int Beta,
+                Board::PawnType PawnType) const;
+    bool PickPoint(SearchContext& Context, MovePicker& Picker, int CurrentDepth, Board::PawnType PawnType,
+                   Board::PawnInfo& Point) const;
+    void GeneratePickerPoints(SearchContext& Context, MovePicker& Picker, int CurrentDepth, Board::PawnType PawnType) const;
+    void OrderPoints(const SearchContext& Context, MoveList& Points, int CurrentDepth,
+                     Board::PawnType PawnType, int HashMove) const;
+    void RecordCutoff(SearchContext& Context, const Board::PawnInfo& Point, int CurrentDepth, int NextDepth,
+                      Board::PawnType PawnType) const;
+    int Evaluate(const SearchContext& Context, Board::PawnInfo& Pawn) const;
+    int CalcScore(const LineMatches& Lines) const;
+    void RefreshLine(SearchContext& Context, int Row, int Column, int Direction, int FirstOffset, int LastOffset) const;
+    void SyncCache(SearchContext& Context) const;
+    void UpdateCache(SearchContext& Context, const Board::PawnInfo& Point) const;
+    void RescoreCell(SearchContext& Context, int Row, int Column) const;
+    void GeneratePoints(SearchContext& Context, Board::PawnType PawnType, MoveList& Points) const;
+    void FindVcxPoints(SearchContext& Context, Board::PawnType PawnType, bool bIsVct, MoveList& Points) const;
+    std::array<char, 9> GetSituation(const Board& Target, const Board::PawnInfo& Pawn, int Direction) const;
+    char GetPawn(const Board& Target, const Board::PawnInfo& Pawn, int Direction, int Offset) const;
+    bool HasLayoutNearPawn(const Board& Target, const Board::PawnInfo& Pawn, PawnLayout Layout) const;
+    int EvalBoard(const SearchContext& Context) const;
+    Board::PawnInfo CalcVcxKill(SearchContext& Context, int NextDepth, bool bIsVct, Board::PawnType PawnType) const;
+    void GenRandomPoints(SearchContext& Context, std::size_t Amount, MoveList& Points) const;
+    Board::PawnInfo DeepingCalcKill(SearchContext& Context, int NextDepth, int MaxDepth, bool bIsVct) const;
+    Board::PawnInfo SolveProofNumbers(SearchContext& Context, bool bIsVct, std::size_t MaxNodes) const;
+    ProofNumberTable::Entry SearchProofNumbers(SearchContext& Context, bool bIsVct, Board::PawnType PawnType,
+                                               std::uint32_t ProofThreshold, std::uint32_t DisproofThreshold) const;
+    void DeepingMinimax(SearchContext& Context, int NextDepth, int MaxDepth) const;
 
 private:
-    void PutPawn(const Board::PawnInfo& Point) {
-        _Board->PutPawn(Point, true, false);
-        CalcHash(Point);
+    void PutPawn(SearchContext& Context, const Board::PawnInfo& Point) const {
+        Context._Board.PutPawn(Point, true, false);
+        UpdateCache(Context, Point);
     }
 
-    void RevokePawn(const Board::PawnInfo& Point) {
-        _Board->PutPawn({ Point.Row, Point.Column, Board::_kEmpty }, true, false);
-        CalcHash(Point);
+    void RevokePawn(SearchContext& Context, const Board::PawnInfo& Point) const {
+        Context._Board.PutPawn({ Point.Row, Point.Column, Board::_kEmpty }, true, false);
+        UpdateCache(Context, Point);
     }
 
     int GetScore(const PawnLayout& Layout) const {
@@ -89,37 +158,45 @@ private:
         return Score >= static_cast<int>(Left) && Score < static_cast<int>(Right);
     }
 
-    long long CalcHash(const Board::PawnInfo& Pawn) {
-        int x = Pawn.Row;
-        int y = Pawn.Column;
-        _HashCode ^= Pawn.Type == Board::_kBlack ? _BlackZobrist[x][y] : _WhiteZobrist[x][y];
-        return _HashCode;
+    int GetLineKey(const Board& Target, const Board::PawnInfo& Pawn, int Direction) const {
+        return Target.GetLineKey(Pawn.Row, Pawn.Column, Direction, Pawn.Type);
+    }
+
+    // VCF and VCT proofs of the same position differ, and so do the attacker's and the defender's turns
+    std::uint64_t GetProofKey(const SearchContext& Context, bool bIsVct, Board::PawnType PawnType) const {
+        return GetProofKey(Context._Board.GetHashCode(), bIsVct, PawnType);
+    }
+
+    std::uint64_t GetProofKey(std::uint64_t HashCode, bool bIsVct, Board::PawnType PawnType) const {
+        std::uint64_t Key = HashCode;
+        if (bIsVct) {
+            Key ^= 0x9E3779B97F4A7C15ULL;
+        }
+        if (PawnType != _MachinePawn) {
+            Key ^= 0xC2B2AE3D27D4EB4FULL;
+        }
+        return Key;
+    }
+
+    // The clock is only read every 1024 nodes, helpers stop the whole search through the shared signal
+    void CheckDeadline(SearchContext& Context) const {
+        if (++Context._NodeCount >= Context._NodeLimit ||
+            ((Context._NodeCount & 1023) == 0 && std::chrono::steady_clock::now() >= Context._HardDeadline)) {
+            Context._StopSignal->store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool IsSoftTimeUp(const SearchContext& Context) const {
+        return std::chrono::steady_clock::now() >= Context._SoftDeadline;
     }
 
 private:
-    const std::vector<std::string> _kFiveLink;
-    const std::vector<std::string> _kFour;
-    const std::vector<std::string> _kBlockFour;
-    const std::vector<std::string> _kThree;
-    const std::vector<std::string> _kBlockThree;
-    const std::vector<std::string> _kTwo;
-    const std::vector<std::string> _kBlockTwo;
-    const std::vector<std::string> _kOne;
-    const std::vector<std::string> _kBlockOne;
-
-    std::shared_ptr<Board>                                             _Board;
-    Board::PawnInfo                                                    _BestMove;
-    Board::PawnType                                                    _MachinePawn;
-    double                                                             _Aggressiveness;
-    std::vector<Board::PawnInfo>                                       _BestMoves;
-    std::vector<std::pair<const std::vector<std::string>, PawnLayout>> _ScoreMap;
-    std::vector<std::vector<long long>>                                _BlackZobrist;
-    std::vector<std::vector<long long>>                                _WhiteZobrist;
-    std::unordered_map<long long, LayoutCache>                         _Cache;
-    std::atomic<long long>                                             _HashCode;
-
-    std::vector<std::thread>    _Threads;
-    std::mutex                  _Mutex;
-    std::condition_variable     _Condition;
-    std::queue<Board::PawnInfo> _Points;
+    std::shared_ptr<Board>              _Board;
+    Board::PawnType                     _MachinePawn;
+    double                              _Aggressiveness;
+    const PatternTable&                 _Patterns;
+    const ThreatSpace&                  _ThreatSpace;
+    const LineKernel&                   _LineKernel;
+    std::shared_ptr<TranspositionTable> _TranspositionTable;
+    std::unique_ptr<SearchContext>      _Context; // last, its helper threads stop before the rest is destroyed
 };
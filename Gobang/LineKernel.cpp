@@ -0,0 +1,114 @@
+#include "LineKernel.h"
+
+#include "PatternTable.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GOBANG_LINE_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GOBANG_LINE_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GOBANG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define GOBANG_TARGET_AVX2
+#endif
+
+namespace {
+    // Board::GetLineKey of the cell at Position, black's view; white's swaps 'X' and '#'
+    int GetBlackKey(std::uint64_t Line, int Position) {
+        std::uint64_t Window = Line >> (2 * Position);
+        return static_cast<int>((Window & 0xFF) | ((Window >> 2) & 0xFF00));
+    }
+
+    int GetWhiteKey(int Key) {
+        int Swap = (Key ^ (Key >> 1)) & 0x5555;
+        return Key ^ (Swap | (Swap << 1));
+    }
+
+    void ClassifyScalar(const std::uint16_t* Table, std::uint64_t Line, int First, int Count,
+                        std::uint16_t* BlackMatches, std::uint16_t* WhiteMatches) {
+        for (int i = 0; i != Count; ++i) {
+            int Key = GetBlackKey(Line, First + i);
+            BlackMatches[i] = Table[Key];
+            WhiteMatches[i] = Table[GetWhiteKey(Key)];
+        }
+    }
+
+#ifdef GOBANG_LINE_KERNEL_X86
+    // 8 cells per round: the windows are cut from the line in 64-bit lanes, packed to 32-bit keys and looked up with
+    // one gather per colour. Positions past the line read zeros, their keys are valid and only their results are junk
+    GOBANG_TARGET_AVX2 void ClassifyAvx2(const std::uint16_t* Table, std::uint64_t Line, int First, int Count,
+                                         std::uint16_t* BlackMatches, std::uint16_t* WhiteMatches) {
+        const __m256i kLine      = _mm256_set1_epi64x(static_cast<long long>(Line));
+        const __m256i kLowMask   = _mm256_set1_epi64x(0xFF);
+        const __m256i kHighMask  = _mm256_set1_epi64x(0xFF00);
+        const __m256i kEvenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        const __m256i kSwapMask  = _mm256_set1_epi32(0x5555);
+        const __m256i kLowHalf   = _mm256_set1_epi32(0xFFFF);
+
+        for (int Base = 0; Base < Count; Base += 8) {
+            int     Shift  = 2 * (First + Base);
+            __m256i Shifts = _mm256_add_epi64(_mm256_set1_epi64x(Shift), _mm256_setr_epi64x(0, 2, 4, 6));
+
+            __m256i Keys[2];
+            for (__m256i& Quad : Keys) {
+                __m256i Window = _mm256_srlv_epi64(kLine, Shifts);
+                Quad   = _mm256_or_si256(_mm256_and_si256(Window, kLowMask),
+                                         _mm256_and_si256(_mm256_srli_epi64(Window, 2), kHighMask));
+                Quad   = _mm256_permutevar8x32_epi32(Quad, kEvenLanes);
+                Shifts = _mm256_add_epi64(Shifts, _mm256_set1_epi64x(8));
+            }
+            __m256i BlackKeys = _mm256_permute2x128_si256(Keys[0], Keys[1], 0x20);
+
+            __m256i Swap      = _mm256_and_si256(_mm256_xor_si256(BlackKeys, _mm256_srli_epi32(BlackKeys, 1)), kSwapMask);
+            __m256i WhiteKeys = _mm256_xor_si256(BlackKeys, _mm256_or_si256(Swap, _mm256_slli_epi32(Swap, 1)));
+
+            const int* Base32 = reinterpret_cast<const int*>(Table);
+            __m256i    Black  = _mm256_and_si256(_mm256_i32gather_epi32(Base32, BlackKeys, 2), kLowHalf);
+            __m256i    White  = _mm256_and_si256(_mm256_i32gather_epi32(Base32, WhiteKeys, 2), kLowHalf);
+
+            // packus works per 128-bit half, black 0-3 white 0-3 black 4-7 white 4-7 is put back in order
+            __m256i Packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(Black, White), 0xD8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(BlackMatches + Base), _mm256_castsi256_si128(Packed));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(WhiteMatches + Base), _mm256_extracti128_si256(Packed, 1));
+        }
+    }
+#endif // GOBANG_LINE_KERNEL_X86
+}
+
+LineKernel::LineKernel() :
+    _Table(PatternTable::GetInstance().GetMatchTable()), _Level(Level::kScalar), _Classify(&ClassifyScalar)
+{
+#ifdef GOBANG_LINE_KERNEL_X86
+    if (HasAvx2()) {
+        _Level    = Level::kAvx2;
+        _Classify = &ClassifyAvx2;
+    }
+#endif // GOBANG_LINE_KERNEL_X86
+}
+
+const LineKernel& LineKernel::GetInstance() {
+    static const LineKernel Instance;
+    return Instance;
+}
+
+bool LineKernel::HasAvx2() {
+#if defined(GOBANG_LINE_KERNEL_X86) && defined(_MSC_VER) && !defined(__clang__)
+    // AVX2 needs the CPU flag and the OS saving the YMM registers
+    int Info[4] = {};
+    __cpuid(Info, 1);
+    bool bOsSaves = (Info[2] & (1 << 27)) && (Info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (!bOsSaves) {
+        return false;
+    }
+    __cpuidex(Info, 7, 0);
+    return (Info[1] & (1 << 5)) != 0;
+#elif defined(GOBANG_LINE_KERNEL_X86)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
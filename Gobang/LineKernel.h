@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Pattern matches of a run of cells on one packed line of the Board (see Board::GetLine), for both colours at once.
+// The AVX2 kernel is picked at startup when the CPU has it, otherwise a scalar loop; both give exactly
+// PatternTable::GetMatches of Board::GetLineKey for every cell
+class LineKernel {
+public:
+    enum class Level {
+        kScalar, kAvx2
+    };
+
+    // Longest run one call classifies, a line has at most 15 cells
+    static constexpr int kMaxCells = 16;
+
+public:
+    LineKernel(const LineKernel&) = delete;
+    LineKernel& operator=(const LineKernel&) = delete;
+
+    static const LineKernel& GetInstance();
+
+    // Matches of the Count cells from position First on. Both outputs hold kMaxCells entries, the ones from Count on
+    // are overwritten with unspecified values
+    void Classify(std::uint64_t Line, int First, int Count, std::uint16_t* BlackMatches, std::uint16_t* WhiteMatches) const {
+        _Classify(_Table, Line, First, Count, BlackMatches, WhiteMatches);
+    }
+
+    Level GetLevel() const {
+        return _Level;
+    }
+
+    const char* GetLevelName() const {
+        return _Level == Level::kAvx2 ? "avx2" : "scalar";
+    }
+
+private:
+    using ClassifyFunction = void (*)(const std::uint16_t* Table, std::uint64_t Line, int First, int Count,
+                                      std::uint16_t* BlackMatches, std::uint16_t* WhiteMatches);
+
+    LineKernel();
+
+    static bool HasAvx2();
+
+private:
+    const std::uint16_t* _Table;
+    Level                _Level;
+    ClassifyFunction     _Classify;
+};
@@ -16,7 +16,7 @@ MainWindow::MainWindow(std::shared_ptr<Board> Board, QWidget* Parent) : _Board(B
     setMouseTracking(true);
     _MainUi.Label_Board->setMouseTracking(true);
 
-    connect(_Board.get(), &Board::Signal_PaintEvent, this, &MainWindow::Slot_PaintEvent);
+    _Board->Subscribe([this](const Board::PawnInfo& Pawn) -> void { Slot_PaintEvent(Pawn); });
 
     SetupAssets();
 }
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "Board.h"
+
+// Fixed capacity list of moves, there is at most one move per cell. Searches keep one per ply in their context, so
+// generating moves never touches the heap
+class MoveList {
+public:
+    static constexpr std::size_t kCapacity = kCellCount;
+
+public:
+    void Push(const Board::PawnInfo& Move) {
+        _Moves[_Size++] = Move;
+    }
+
+    void Clear() {
+        _Size = 0;
+    }
+
+    // Keeps the first Size moves
+    void Truncate(std::size_t Size) {
+        if (Size < _Size) {
+            _Size = Size;
+        }
+    }
+
+    void Append(const MoveList& Other) {
+        for (const auto& Move : Other) {
+            Push(Move);
+        }
+    }
+
+    // Stable insertion sort, the lists are short and std::stable_sort would allocate a buffer
+    template <typename Compare>
+    void StableSort(Compare Less) {
+        for (std::size_t i = 1; i < _Size; ++i) {
+            Board::PawnInfo Move = _Moves[i];
+            std::size_t     j    = i;
+            for (; j != 0 && Less(Move, _Moves[j - 1]); --j) {
+                _Moves[j] = _Moves[j - 1];
+            }
+            _Moves[j] = Move;
+        }
+    }
+
+    std::size_t Size() const {
+        return _Size;
+    }
+
+    bool Empty() const {
+        return _Size == 0;
+    }
+
+    Board::PawnInfo& operator[](std::size_t Index) {
+        return _Moves[Index];
+    }
+
+    const Board::PawnInfo& operator[](std::size_t Index) const {
+        return _Moves[Index];
+    }
+
+    const Board::PawnInfo& Front() const {
+        return _Moves[0];
+    }
+
+    Board::PawnInfo* begin() {
+        return _Moves.data();
+    }
+
+    Board::PawnInfo* end() {
+        return _Moves.data() + _Size;
+    }
+
+    const Board::PawnInfo* begin() const {
+        return _Moves.data();
+    }
+
+    const Board::PawnInfo* end() const {
+        return _Moves.data() + _Size;
+    }
+
+private:
+    std::array<Board::PawnInfo, kCapacity> _Moves;
+    std::size_t                            _Size = 0;
+};
@@ -0,0 +1,57 @@
+#include "PatternTable.h"
+
+#include <string>
+
+PatternTable::PatternTable() : _LayoutTable{} {
+    const char kCodes[] = { '_', 'X', '#', '-' };
+
+    for (int Key = 0; Key != (1 << 16); ++Key) {
+        std::string Situation;
+        for (int Offset = -4; Offset <= 4; ++Offset) {
+            if (Offset == 0) {
+                Situation.push_back('X');
+            } else {
+                int Slot = Offset < 0 ? Offset + 4 : Offset + 3;
+                Situation.push_back(kCodes[(Key >> (2 * Slot)) & 3]);
+            }
+        }
+
+        // Off-board cells can only run from the ends of the line inwards, the other keys never occur
+        std::size_t LeftEdge  = Situation.find_last_of('-', 3);
+        std::size_t RightEdge = Situation.find_first_of('-', 5);
+        if ((LeftEdge  != std::string::npos && Situation.find_first_not_of('-') <= LeftEdge) ||
+            (RightEdge != std::string::npos && Situation.find_last_not_of('-')  >= RightEdge)) {
+            continue;
+        }
+
+        for (std::size_t i = 0; i != kScoreMap.size(); ++i) {
+            if (HasLayout(Situation, kScoreMap[i].Patterns)) {
+                _LayoutTable[Key] |= static_cast<std::uint16_t>(1 << i);
+            }
+        }
+    }
+}
+
+const PatternTable& PatternTable::GetInstance() {
+    static const PatternTable Instance;
+    return Instance;
+}
+
+PatternTable::PawnLayout PatternTable::GetPawnLayout(std::string_view Situation) {
+    for (const auto& Group : kScoreMap) {
+        if (HasLayout(Situation, Group.Patterns)) {
+            return Group.Layout;
+        }
+    }
+
+    return PawnLayout::kEmpty;
+}
+
+bool PatternTable::HasLayout(std::string_view Situation, std::span<const std::string_view> Patterns) {
+    for (const auto& Pattern : Patterns) {
+        if (Situation.contains(Pattern)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Line patterns, their scores and the per-key match table, built once and shared read-only by every Evaluator
+class PatternTable {
+public:
+    enum class PawnLayout : int {
+        kFiveLink   = 10000000, // 连五
+        kFour       = 1000000,  // 活四
+        kMultiFour  = 800000,   // 多冲四
+        kFourThree  = 500000,   // 冲四活三
+        kMultiThree = 100000,   // 多活三
+        kThree      = 10000,    // 活三
+        kBlockFour  = 9000,     // 冲四
+        kTwo        = 100,      // 活二
+        kOne        = 80,       // 活一
+        kBlockThree = 30,       // 眠三
+        kBlockTwo   = 10,       // 眠二
+        kBlockOne   = 1,        // 眠一
+        kEmpty      = 0,
+
+        kHighRisk   = kMultiFour,
+        kMiddleRisk = kFourThree,
+        kLowRisk    = kMultiThree
+    };
+
+    struct PatternGroup {
+        std::span<const std::string_view> Patterns;
+        PawnLayout                        Layout;
+    };
+
+private:
+    static constexpr std::string_view _kFiveLink[]   = { "XXXXX" }; // 连五
+    static constexpr std::string_view _kFour[]       = { "_XXXX_" }; // 活四
+    static constexpr std::string_view _kThree[]      = { "_XXX__", "_XX_X_", "_X_XX_", "__XXX_" }; // 活三
+    static constexpr std::string_view _kBlockFour[]  = { "_XXXX", "X_XXX", "XX_XX", "XXX_X", "XXXX_" }; // 冲四
+    static constexpr std::string_view _kTwo[]        = { "__XX__", "_XX___", "___XX_", "_X_X__", "__X_X_" }; // 活二
+    static constexpr std::string_view _kOne[]        = { "_X_#__", "__#_X_", "_#_X__", "__X_#_", "#_X___", "___X_#", "___#_X", "X_#___" }; // 活一
+    static constexpr std::string_view _kBlockThree[] = { "#XXX__", "#XX_X_", "#X_XX_", "__XXX#", "_X_XX#", "_XX_X#" }; // 眠三
+    static constexpr std::string_view _kBlockTwo[]   = { "_XX#__", "__XX#_", "__#XX_", "_#XX__", "___XX#", "#XX___", "XX____", "____XX" }; // 眠二
+    static constexpr std::string_view _kBlockOne[]   = { "__X#__", "__#X__", "___#X_", "_X#___", "#X____", "____X#" }; // 眠一
+
+public:
+    // Checked in this order, the first group found in a line decides its layout
+    static constexpr std::array<PatternGroup, 9> kScoreMap = { {
+        { _kFiveLink,   PawnLayout::kFiveLink },
+        { _kFour,       PawnLayout::kFour },
+        { _kThree,      PawnLayout::kThree },
+        { _kBlockFour,  PawnLayout::kBlockFour },
+        { _kTwo,        PawnLayout::kTwo },
+        { _kOne,        PawnLayout::kOne },
+        { _kBlockThree, PawnLayout::kBlockThree },
+        { _kBlockTwo,   PawnLayout::kBlockTwo },
+        { _kBlockOne,   PawnLayout::kBlockOne },
+    } };
+
+public:
+    PatternTable(const PatternTable&) = delete;
+    PatternTable& operator=(const PatternTable&) = delete;
+
+    static const PatternTable& GetInstance();
+
+    // Bit i is set when the line of Key (see Board::GetLineKey) contains a pattern of kScoreMap[i]
+    std::uint16_t GetMatches(int Key) const {
+        return _LayoutTable[Key];
+    }
+
+    // The whole table indexed by key, with a spare zero entry after the last one so that 32-bit loads at any key
+    // stay inside it
+    const std::uint16_t* GetMatchTable() const {
+        return _LayoutTable.data();
+    }
+
+    static PawnLayout GetLineLayout(std::uint16_t Matches) {
+        return Matches == 0 ? PawnLayout::kEmpty : kScoreMap[std::countr_zero(Matches)].Layout;
+    }
+
+    static constexpr std::uint16_t GetLayoutMask(PawnLayout Layout) {
+        for (std::size_t i = 0; i != kScoreMap.size(); ++i) {
+            if (kScoreMap[i].Layout == Layout) {
+                return static_cast<std::uint16_t>(1 << i);
+            }
+        }
+        return 0;
+    }
+
+    static PawnLayout GetPawnLayout(std::string_view Situation);
+    static bool HasLayout(std::string_view Situation, std::span<const std::string_view> Patterns);
+
+private:
+    PatternTable();
+
+private:
+    std::array<std::uint16_t, (1 << 16) + 1> _LayoutTable;
+};
@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <chrono>
+#include <iostream>
 #include <limits>
 #include <random>
 
@@ -53,22 +54,25 @@ void Player::MachinePutPawn(const Board::PawnInfo& LastHumanPawn) {
         return;
     }
 
-    if (_Board->GetPawnCount() <= 6) {
-        _Board->PutPawn(_Evaluator->GetBestMove(6), true);
-    } else if (_Board->GetPawnCount() <= 10) {
-        _Board->PutPawn(_Evaluator->GetBestMove(6, true, 8), true);
-    } else if (_Board->GetPawnCount() <= 30) {
-        _Board->PutPawn(_Evaluator->GetBestMove(8, true, 10), true);
-    } else if (_Board->GetPawnCount() <= 60) {
-        _Board->PutPawn(_Evaluator->GetBestMove(10, true, 12), true);
-    } else {
-        _Board->PutPawn(_Evaluator->GetBestMove(12, true, 12), true);
+    Evaluator::SearchLimits Limits;
+    Limits.MaxDepth         = 12;
+    Limits.bProcessCalcKill = _Board->GetPawnCount() > 6;
+    Limits.MaxVcxDepth      = 12;
+    Limits.SoftTime         = _kSoftTime;
+    Limits.HardTime         = _kHardTime;
+    _Board->PutPawn(_Evaluator->GetBestMove(Limits), true);
+    const Board::PawnInfo& KillMove = _Evaluator->GetKillMove();
+    if (KillMove.Type != Board::_kEmpty) {
+        std::clog << "Calculate kill: (" << KillMove.Row << ", " << KillMove.Column << ")" << std::endl;
     }
 
     _bHumanFlag = !_bHumanFlag;
     auto   EndTime  = std::chrono::steady_clock::now();
     double Duration = std::chrono::duration<double>(EndTime - BeginTime).count();
     std::cout << "Duration time: " << Duration << "s" << std::endl;
+    if constexpr (SearchStatistics::kEnabled) {
+        std::cout << "Search statistics: " << _Evaluator->GetStatistics().ToJson() << std::endl;
+    }
 }
 
 void Player::Slot_MouseEvent(QMouseEvent* Event) {
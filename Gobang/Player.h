@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <QMouseEvent>
 #include <QObject>
@@ -24,6 +25,9 @@ private slots:
     void Slot_MouseEvent(QMouseEvent* Event);
 
 private:
+    static constexpr std::chrono::milliseconds _kSoftTime{ 2000 };
+    static constexpr std::chrono::milliseconds _kHardTime{ 5000 };
+
     std::shared_ptr<Board>      _Board;
     std::shared_ptr<Evaluator>  _Evaluator;
     std::shared_ptr<MainWindow> _MainWindow;
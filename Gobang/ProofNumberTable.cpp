@@ -0,0 +1,37 @@
+#include "ProofNumberTable.h"
+
+#include <algorithm>
+#include <bit>
+
+ProofNumberTable::ProofNumberTable(std::size_t SizeInMB) {
+    std::size_t BucketCount = std::bit_floor(std::max<std::size_t>(SizeInMB * 1024 * 1024 / sizeof(Bucket), 1));
+    _Buckets.assign(BucketCount, Bucket{});
+    _Mask = BucketCount - 1;
+}
+
+bool ProofNumberTable::Probe(std::uint64_t Key, Entry& Result) const {
+    for (const auto& Slot : _Buckets[Key & _Mask].Entries) {
+        if (Slot.Key == Key && Slot.Work != 0) {
+            Result = Slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProofNumberTable::Store(const Entry& NewEntry) {
+    Bucket& Target = _Buckets[NewEntry.Key & _Mask];
+
+    Entry* Victim = &Target.Entries[0];
+    for (auto& Slot : Target.Entries) {
+        if (Slot.Key == NewEntry.Key && Slot.Work != 0) {
+            Slot = NewEntry;
+            return;
+        }
+        if (Slot.Work < Victim->Work) {
+            Victim = &Slot;
+        }
+    }
+
+    *Victim = NewEntry;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Proof and disproof numbers of the df-pn threat solver. Fixed size, within a bucket the entry with the least work
+// below it is replaced first, so large solved subtrees survive longest
+class ProofNumberTable {
+public:
+    struct Entry {
+        std::uint64_t Key            = 0;
+        std::uint32_t ProofNumber    = 1;
+        std::uint32_t DisproofNumber = 1;
+        std::uint32_t Work           = 0;       // nodes searched below the entry, 0 for an empty slot
+        std::uint8_t  Move           = kNoMove; // Board index of the most promising child, the winning move once proven
+    };
+
+private:
+    // Two entries fill one cache line
+    struct alignas(64) Bucket {
+        std::array<Entry, 2> Entries;
+    };
+
+public:
+    static constexpr std::uint32_t kInfinity = 0x3FFFFFFF; // sums of two numbers below it never overflow
+    static constexpr std::uint8_t  kNoMove   = 0xFF;
+
+public:
+    explicit ProofNumberTable(std::size_t SizeInMB);
+
+    bool Probe(std::uint64_t Key, Entry& Result) const;
+    void Store(const Entry& NewEntry);
+
+    std::size_t GetSizeInBytes() const {
+        return _Buckets.size() * sizeof(Bucket);
+    }
+
+private:
+    std::vector<Bucket> _Buckets;
+    std::uint64_t       _Mask;
+};
@@ -0,0 +1,68 @@
+#include "ProofTable.h"
+
+#include <algorithm>
+#include <bit>
+
+ProofTable::ProofTable(std::size_t SizeInMB) : _BucketCount(0) {
+    _BucketCount = std::bit_floor(std::max<std::size_t>(SizeInMB * 1024 * 1024 / sizeof(Bucket), 1));
+    _Buckets     = std::make_unique<Bucket[]>(_BucketCount);
+}
+
+bool ProofTable::Probe(std::uint64_t Key, Entry& Result) const {
+    for (const auto& Source : GetBucket(Key).Slots) {
+        Entry Current = Load(Source);
+        if (Current.Key == Key && Current.Result != ProofResult::kUnknown) {
+            Result = Current;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProofTable::Store(std::uint64_t Key, ProofResult Result, int Depth, int Move) {
+    Bucket& Target = GetBucket(Key);
+    Entry   NewEntry{ Key, static_cast<std::int8_t>(Depth), Result, Move < 0 ? kNoMove : static_cast<std::uint8_t>(Move) };
+
+    // A proven win never needs a deeper search, so it is kept over any failure of the same position and replaces one
+    // unconditionally. Of two failures the deeper one rules out more and is kept
+    std::size_t Victim      = 0;
+    Entry       VictimEntry = Load(Target.Slots[0]);
+    for (std::size_t i = 0; i != Target.Slots.size(); ++i) {
+        Entry Current = Load(Target.Slots[i]);
+        if (Current.Key == Key && Current.Result != ProofResult::kUnknown) {
+            if (Result == ProofResult::kWin || (Current.Result == ProofResult::kNoWin && Depth >= Current.Depth)) {
+                Save(Target.Slots[i], NewEntry);
+            }
+            return;
+        }
+        if (Current.Result == ProofResult::kUnknown) {
+            Victim      = i;
+            VictimEntry = Current;
+        } else if (VictimEntry.Result != ProofResult::kUnknown && Current.Depth < VictimEntry.Depth) {
+            Victim      = i;
+            VictimEntry = Current;
+        }
+    }
+
+    Save(Target.Slots[Victim], NewEntry);
+}
+
+ProofTable::Entry ProofTable::Load(const Slot& Source) {
+    std::uint64_t Check = Source.Check.load(std::memory_order_relaxed);
+    std::uint64_t Data  = Source.Data.load(std::memory_order_relaxed);
+
+    Entry Result;
+    Result.Key    = Check ^ Data;
+    Result.Depth  = static_cast<std::int8_t>(Data);
+    Result.Result = static_cast<ProofResult>((Data >> 8) & 0xFF);
+    Result.Move   = static_cast<std::uint8_t>(Data >> 16);
+    return Result;
+}
+
+void ProofTable::Save(Slot& Target, const Entry& Source) {
+    std::uint64_t Data = static_cast<std::uint64_t>(static_cast<std::uint8_t>(Source.Depth)) |
+                         static_cast<std::uint64_t>(Source.Result) << 8 |
+                         static_cast<std::uint64_t>(Source.Move)   << 16;
+    Target.Check.store(Source.Key ^ Data, std::memory_order_relaxed);
+    Target.Data.store(Data, std::memory_order_relaxed);
+}
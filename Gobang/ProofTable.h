@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Results of the VCF/VCT solver, kept apart from the Minimax transposition table. Shared by the solver threads of a
+// context without locks, like the transposition table every slot keeps Key ^ Data next to Data
+class ProofTable {
+public:
+    enum class ProofResult : std::uint8_t {
+        kUnknown, kWin, kNoWin
+    };
+
+    struct Entry {
+        std::uint64_t Key    = 0;
+        std::int8_t   Depth  = 0;
+        ProofResult   Result = ProofResult::kUnknown;
+        std::uint8_t  Move   = kNoMove; // Board index of the winning move
+    };
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> Check;
+        std::atomic<std::uint64_t> Data;
+    };
+
+    struct alignas(64) Bucket {
+        std::array<Slot, 4> Slots;
+    };
+
+public:
+    static constexpr std::uint8_t kNoMove = 0xFF;
+
+public:
+    explicit ProofTable(std::size_t SizeInMB);
+
+    bool Probe(std::uint64_t Key, Entry& Result) const;
+    void Store(std::uint64_t Key, ProofResult Result, int Depth, int Move);
+
+    std::size_t GetSizeInBytes() const {
+        return _BucketCount * sizeof(Bucket);
+    }
+
+private:
+    static Entry Load(const Slot& Source);
+    static void Save(Slot& Target, const Entry& Source);
+
+    Bucket& GetBucket(std::uint64_t Key) const {
+        return _Buckets[Key & (_BucketCount - 1)];
+    }
+
+private:
+    std::unique_ptr<Bucket[]> _Buckets;
+    std::size_t               _BucketCount;
+};
@@ -0,0 +1,98 @@
+#include "SearchContext.h"
+
+#include <functional>
+#include <limits>
+
+#include "Evaluator.h"
+
+SearchContext::SearchContext(const Evaluator& Engine, const Board& Position, std::size_t ThreadCount,
+                             std::size_t ProofTableSizeInMB) :
+    SearchContext(Position)
+{
+    _ProofTable       = std::make_unique<ProofTable>(ProofTableSizeInMB);
+    _SharedProofTable = _ProofTable.get();
+    _ProofNumberTable = std::make_unique<ProofNumberTable>(ProofTableSizeInMB);
+    for (std::size_t i = 1; i < ThreadCount; ++i) {
+        auto Helper = std::unique_ptr<SearchContext>(new SearchContext(Position));
+        Helper->_SharedProofTable = _SharedProofTable;
+        Helper->_StopSignal       = &_bStopSearch;
+        _Helpers.push_back(std::move(Helper));
+    }
+
+    for (std::size_t i = 0; i != _Helpers.size(); ++i) {
+        _Threads.emplace_back(&Evaluator::HelperLoop, &Engine, std::ref(*this), i);
+    }
+}
+
+SearchContext::SearchContext(const Board& Position) :
+    _Board(Position), _BestMove({}), _KillMove({}), _PawnScores{}, _SharedProofTable(nullptr),
+    _SoftDeadline(std::chrono::steady_clock::time_point::max()), _HardDeadline(std::chrono::steady_clock::time_point::max()),
+    _NodeCount(0), _NodeLimit(std::numeric_limits<std::size_t>::max()), _RandomEngine(std::random_device{}()),
+    _PlyPoints(kCellCount + 1),
+    _VcxFirstDepth(0), _bStopSearch(false), _StopSignal(&_bStopSearch), _SearchCount(0), _ActiveHelpers(0),
+    _HelperTask(HelperTask::kMinimax), _HelperMaxDepth(0), _bHelperIsVct(false), _bQuit(false)
+{
+    ClearMoveOrdering();
+}
+
+SearchContext::~SearchContext() {
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _bQuit = true;
+    }
+    _bStopSearch = true;
+    _Condition.notify_all();
+    for (auto& Thread : _Threads) {
+        Thread.join();
+    }
+}
+
+void SearchContext::SetSeed(std::uint64_t Seed) {
+    _RandomEngine.seed(Seed);
+    for (std::size_t i = 0; i != _Helpers.size(); ++i) {
+        _Helpers[i]->_RandomEngine.seed(Seed + i + 1);
+    }
+}
+
+void SearchContext::ReserveMoveLists() {
+    for (auto& Points : _PlyPoints) {
+        if (!Points) {
+            Points = std::make_unique<MoveList>();
+        }
+    }
+    for (auto& Helper : _Helpers) {
+        Helper->ReserveMoveLists();
+    }
+}
+
+std::size_t SearchContext::GetTableSizeInBytes() const {
+    return (_ProofTable ? _ProofTable->GetSizeInBytes() : 0) + (_ProofNumberTable ? _ProofNumberTable->GetSizeInBytes() : 0);
+}
+
+std::size_t SearchContext::GetSizeInBytes() const {
+    std::size_t Size = sizeof(SearchContext) + _PlyPoints.capacity() * sizeof(std::unique_ptr<MoveList>) +
+                       GetTableSizeInBytes();
+    for (const auto& Points : _PlyPoints) {
+        if (Points) {
+            Size += sizeof(MoveList);
+        }
+    }
+    for (const auto& Helper : _Helpers) {
+        Size += Helper->GetSizeInBytes();
+    }
+    return Size;
+}
+
+std::size_t SearchContext::GetBufferSizeInBytes() {
+    return sizeof(SearchContext) + (kCellCount + 1) * (sizeof(std::unique_ptr<MoveList>) + sizeof(MoveList));
+}
+
+// Killers and history only describe the current position, every search starts from scratch so runs stay reproducible
+void SearchContext::ClearMoveOrdering() {
+    for (auto& Killers : _Killers) {
+        Killers.fill(-1);
+    }
+    for (auto& History : _History) {
+        History.fill(0);
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "MoveList.h"
+#include "ProofNumberTable.h"
+#include "ProofTable.h"
+#include "SearchStatistics.h"
+
+class Evaluator;
+
+// Everything a search changes: its own copy of the board, the pattern caches kept in step with it, the proof tables,
+// move ordering, limits and the helper threads. The Evaluator only holds configuration and the shared transposition
+// table, so any number of contexts can search with one Evaluator at the same time, each from its own thread.
+// A context must not outlive the Evaluator it was made for
+class SearchContext {
+    friend class Benchmark;
+    friend class Evaluator;
+
+private:
+    using LineMatches = std::array<std::uint16_t, 4>;
+
+    enum class HelperTask {
+        kMinimax, kCalcKill
+    };
+
+    struct VcxTask {
+        Board::PawnInfo Point;
+        int             NextDepth = 0;
+    };
+
+public:
+    static constexpr std::size_t kDefaultProofTableSizeInMB = 4;
+
+public:
+    // ThreadCount - 1 helper threads search the same root on their own board copies. All threads share one proof table
+    // of ProofTableSizeInMB, so VCF/VCT tasks reuse each other's proofs; the df-pn table of the main context is as large
+    // again
+    SearchContext(const Evaluator& Engine, const Board& Position, std::size_t ThreadCount = 1,
+                  std::size_t ProofTableSizeInMB = kDefaultProofTableSizeInMB);
+    SearchContext(const SearchContext&) = delete;
+    ~SearchContext();
+
+    // Later searches start from Position, the board given here is copied and never changed by the search
+    void SetPosition(const Board& Position) {
+        _Board = Position;
+    }
+
+    const Board& GetPosition() const {
+        return _Board;
+    }
+
+    // Replaces the random move choices with ones derived from Seed, so that with one thread and no time limits the
+    // same position always gives the same tree and the same move
+    void SetSeed(std::uint64_t Seed);
+
+    // Makes the move lists of every ply up front, of the context and its helpers. Searches otherwise make them on first
+    // use; after this call a single threaded search does not allocate at all
+    void ReserveMoveLists();
+
+    // Proof tables of the context, the helpers have none of their own
+    std::size_t GetTableSizeInBytes() const;
+
+    // Everything the context and its helpers hold now: the tables, the contexts themselves and the move lists made so far
+    std::size_t GetSizeInBytes() const;
+
+    // What a context without helpers holds besides its tables once every move list is made
+    static std::size_t GetBufferSizeInBytes();
+
+    // Statistics of the last search, all zero unless built with GOBANG_SEARCH_STATISTICS
+    const SearchStatistics& GetStatistics() const {
+        return _Statistics;
+    }
+
+private:
+    explicit SearchContext(const Board& Position);
+
+    void ClearMoveOrdering();
+
+    // Moves of the node at the current pawn count, made on first use, so a search reaching no new depth allocates nothing.
+    // The board holds at most kCellCount pawns, one list per count
+    MoveList& GetPlyPoints() {
+        assert(_Board.GetPawnCount() < _PlyPoints.size());
+        auto& Points = _PlyPoints[_Board.GetPawnCount()];
+        if (!Points) {
+            Points = std::make_unique<MoveList>();
+        }
+        return *Points;
+    }
+
+private:
+    static constexpr int _kMaxPly = 32;
+
+    Board                                              _Board;
+    Board::PawnInfo                                    _BestMove;
+    Board::PawnInfo                                    _KillMove;   // VCF/VCT win of the last search, empty if none
+    std::array<std::array<LineMatches, kCellCount>, 2> _LineCache;  // [PawnType - 1][Index][Direction]
+    std::array<std::array<int, kCellCount>, 2>         _ScoreCache; // [PawnType - 1][Index]
+    std::array<int, 2>                                 _PawnScores; // [PawnType - 1], sum over the pawns on board
+    std::unique_ptr<ProofTable>                        _ProofTable;       // main context only
+    ProofTable*                                        _SharedProofTable; // the owner's _ProofTable in helpers
+    std::unique_ptr<ProofNumberTable>                  _ProofNumberTable; // main context only, df-pn is sequential
+    std::chrono::steady_clock::time_point              _SoftDeadline;
+    std::chrono::steady_clock::time_point              _HardDeadline;
+    std::size_t                                        _NodeCount;
+    std::size_t                                        _NodeLimit;
+    std::mt19937_64                                    _RandomEngine;
+    SearchStatistics                                   _Statistics;
+    std::array<std::array<int, 2>, _kMaxPly>           _Killers;    // [Ply], Board indices, -1 if unused
+    std::array<std::array<int, kCellCount>, 2>         _History;    // [PawnType - 1][Index]
+    std::vector<std::unique_ptr<MoveList>>             _PlyPoints;  // [PawnCount]
+    std::array<MoveList, 4>                            _Buckets;    // scratch of GeneratePoints and FindVcxPoints
+
+    std::vector<std::unique_ptr<SearchContext>> _Helpers;
+    std::vector<std::thread>                    _Threads;
+    std::mutex                                  _Mutex;
+    std::condition_variable                     _Condition;
+    std::queue<VcxTask>                         _VcxTasks;
+    Board::PawnInfo                             _VcxPoint;
+    int                                         _VcxFirstDepth; // depth of the first queued tasks
+    std::atomic<bool>                           _bStopSearch;
+    std::atomic<bool>*                          _StopSignal; // the owner's _bStopSearch in helpers
+    std::size_t                                 _SearchCount;
+    std::size_t                                 _ActiveHelpers;
+    HelperTask                                  _HelperTask;
+    int                                         _HelperMaxDepth;
+    bool                                        _bHelperIsVct;
+    bool                                        _bQuit;
+};
@@ -0,0 +1,50 @@
+#include "SearchStatistics.h"
+
+#include <sstream>
+
+void SearchStatistics::Merge(const SearchStatistics& Other) {
+    if constexpr (kEnabled) {
+        Nodes           += Other.Nodes;
+        LeafEvaluations += Other.LeafEvaluations;
+        GenerateCalls   += Other.GenerateCalls;
+        GeneratedPoints += Other.GeneratedPoints;
+        TableProbes     += Other.TableProbes;
+        TableHits       += Other.TableHits;
+        TableCollisions += Other.TableCollisions;
+        TableCutoffs    += Other.TableCutoffs;
+        VcxNodes        += Other.VcxNodes;
+        for (std::size_t i = 0; i != kCutoffSlots; ++i) {
+            Cutoffs[i] += Other.Cutoffs[i];
+        }
+    }
+}
+
+std::string SearchStatistics::ToJson() const {
+    std::ostringstream Stream;
+    Stream << "{\"enabled\":" << (kEnabled ? "true" : "false")
+           << ",\"nodes\":" << Nodes
+           << ",\"leaf_evaluations\":" << LeafEvaluations
+           << ",\"generate_calls\":" << GenerateCalls
+           << ",\"average_branching\":" << GetAverageBranching()
+           << ",\"tt_probes\":" << TableProbes
+           << ",\"tt_hits\":" << TableHits
+           << ",\"tt_collisions\":" << TableCollisions
+           << ",\"tt_cutoffs\":" << TableCutoffs
+           << ",\"vcx_nodes\":" << VcxNodes
+           << ",\"seconds\":" << TotalSeconds
+           << ",\"nps\":" << GetNodesPerSecond()
+           << ",\"cutoff_indices\":[";
+    for (std::size_t i = 0; i != kCutoffSlots; ++i) {
+        Stream << (i == 0 ? "" : ",") << Cutoffs[i];
+    }
+
+    Stream << "],\"iterations\":[";
+    for (std::size_t i = 0; i != IterationCount; ++i) {
+        const Iteration& Current = Iterations[i];
+        Stream << (i == 0 ? "" : ",")
+               << "{\"depth\":" << Current.Depth << ",\"seconds\":" << Current.Seconds << ",\"nodes\":" << Current.Nodes << "}";
+    }
+    Stream << "]}";
+
+    return Stream.str();
+}
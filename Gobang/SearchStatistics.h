@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counters of a single GetBestMove call, define GOBANG_SEARCH_STATISTICS to collect them,
+// otherwise every update compiles to nothing
+class SearchStatistics {
+public:
+#ifdef GOBANG_SEARCH_STATISTICS
+    static constexpr bool kEnabled = true;
+#else
+    static constexpr bool kEnabled = false;
+#endif // GOBANG_SEARCH_STATISTICS
+
+    static constexpr std::size_t kCutoffSlots   = 8;  // the last slot also counts every later cutoff
+    static constexpr std::size_t kMaxIterations = 32; // deeper iterations are not recorded
+
+    struct Iteration {
+        int           Depth   = 0;
+        double        Seconds = 0.0;
+        std::uint64_t Nodes   = 0; // main thread nodes up to the end of the iteration
+    };
+
+public:
+    // Clears the counters in place, statistics never touch the heap during a search
+    void Reset() {
+        if constexpr (kEnabled) {
+            Nodes           = 0;
+            LeafEvaluations = 0;
+            GenerateCalls   = 0;
+            GeneratedPoints = 0;
+            TableProbes     = 0;
+            TableHits       = 0;
+            TableCollisions = 0;
+            TableCutoffs    = 0;
+            VcxNodes        = 0;
+            Cutoffs.fill(0);
+            IterationCount  = 0;
+            TotalSeconds    = 0.0;
+        }
+    }
+
+    void AddNode() {
+        if constexpr (kEnabled) {
+            ++Nodes;
+        }
+    }
+
+    void AddLeafEvaluation() {
+        if constexpr (kEnabled) {
+            ++LeafEvaluations;
+        }
+    }
+
+    void AddGeneration(std::size_t PointCount) {
+        if constexpr (kEnabled) {
+            ++GenerateCalls;
+            GeneratedPoints += PointCount;
+        }
+    }
+
+    void AddTableProbe(bool bHit, bool bCollision) {
+        if constexpr (kEnabled) {
+            ++TableProbes;
+            TableHits       += bHit;
+            TableCollisions += bCollision;
+        }
+    }
+
+    void AddTableCutoff() {
+        if constexpr (kEnabled) {
+            ++TableCutoffs;
+        }
+    }
+
+    void AddCutoff(std::size_t MoveIndex) {
+        if constexpr (kEnabled) {
+            ++Cutoffs[MoveIndex < kCutoffSlots ? MoveIndex : kCutoffSlots - 1];
+        }
+    }
+
+    void AddVcxNode() {
+        if constexpr (kEnabled) {
+            ++VcxNodes;
+        }
+    }
+
+    void AddIteration(int Depth, double Seconds) {
+        if constexpr (kEnabled) {
+            if (IterationCount < kMaxIterations) {
+                Iterations[IterationCount++] = { Depth, Seconds, Nodes };
+            }
+        }
+    }
+
+    void SetSeconds(double Seconds) {
+        if constexpr (kEnabled) {
+            TotalSeconds = Seconds;
+        }
+    }
+
+    double GetAverageBranching() const {
+        return GenerateCalls == 0 ? 0.0 : static_cast<double>(GeneratedPoints) / GenerateCalls;
+    }
+
+    double GetNodesPerSecond() const {
+        return TotalSeconds <= 0.0 ? 0.0 : (Nodes + VcxNodes) / TotalSeconds;
+    }
+
+    // Adds the counters of a helper thread, iterations stay those of the main thread
+    void Merge(const SearchStatistics& Other);
+    std::string ToJson() const;
+
+public:
+    std::uint64_t                            Nodes           = 0;
+    std::uint64_t                            LeafEvaluations = 0;
+    std::uint64_t                            GenerateCalls   = 0;
+    std::uint64_t                            GeneratedPoints = 0;
+    std::uint64_t                            TableProbes     = 0;
+    std::uint64_t                            TableHits       = 0;
+    std::uint64_t                            TableCollisions = 0; // misses on a bucket filled by other positions of this search
+    std::uint64_t                            TableCutoffs    = 0;
+    std::uint64_t                            VcxNodes        = 0;
+    std::array<std::uint64_t, kCutoffSlots> Cutoffs{};           // [index of the move that caused the cutoff]
+    std::array<Iteration, kMaxIterations>   Iterations{};
+    std::size_t                              IterationCount  = 0;
+    double                                   TotalSeconds    = 0.0;
+};
@@ -0,0 +1,110 @@
+#include "ThreatSpace.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "PatternTable.h"
+
+ThreatSpace::ThreatSpace() : _Threats{} {
+    const PatternTable& Patterns = PatternTable::GetInstance();
+    const std::uint16_t kFiveMask = PatternTable::GetLayoutMask(PatternTable::PawnLayout::kFiveLink);
+
+    // Pattern matches always run through the center, so these are the cells completing five together with it
+    auto GetFiveSquares = [&](int Key) -> std::uint8_t {
+        std::uint8_t Squares = 0;
+        for (int Slot = 0; Slot != 8; ++Slot) {
+            if (((Key >> (2 * Slot)) & 3) == 0 && (Patterns.GetMatches(Key | (1 << (2 * Slot))) & kFiveMask)) {
+                Squares |= 1 << Slot;
+            }
+        }
+        return Squares;
+    };
+
+    auto HasOpenFourMove = [&](int Key) -> bool {
+        for (int Slot = 0; Slot != 8; ++Slot) {
+            if (((Key >> (2 * Slot)) & 3) == 0 && std::popcount(GetFiveSquares(Key | (1 << (2 * Slot)))) >= 2) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (int Key = 0; Key != (1 << 16); ++Key) {
+        LineThreat& Threat = _Threats[Key];
+        if (Patterns.GetMatches(Key) & kFiveMask) {
+            Threat.Type = ThreatType::kFive;
+            continue;
+        }
+
+        std::uint8_t FiveSquares = GetFiveSquares(Key);
+        if (FiveSquares != 0) {
+            Threat.Type        = std::popcount(FiveSquares) >= 2 ? ThreatType::kOpenFour : ThreatType::kFour;
+            Threat.CostSquares = FiveSquares;
+            continue;
+        }
+
+        if (!HasOpenFourMove(Key)) {
+            continue;
+        }
+
+        // A three is answered by every cell after which no open four is left on the line
+        Threat.Type = ThreatType::kThree;
+        for (int Slot = 0; Slot != 8; ++Slot) {
+            if (((Key >> (2 * Slot)) & 3) == 0 && !HasOpenFourMove(Key | (2 << (2 * Slot)))) {
+                Threat.CostSquares |= 1 << Slot;
+            }
+        }
+    }
+}
+
+const ThreatSpace& ThreatSpace::GetInstance() {
+    static const ThreatSpace Instance;
+    return Instance;
+}
+
+ThreatSpace::ThreatType ThreatSpace::GetThreat(const Board& Target, int Index, Board::PawnType Type) const {
+    int        Row    = Index / kBoardSize;
+    int        Column = Index % kBoardSize;
+    ThreatType Result = ThreatType::kNone;
+    for (int Direction = 0; Direction != 4; ++Direction) {
+        Result = std::max(Result, _Threats[Target.GetLineKey(Row, Column, Direction, Type)].Type);
+    }
+    return Result;
+}
+
+bool ThreatSpace::FindDefenses(const Board& Target, Board::PawnType Attacker, BitBoard& Defenses) const {
+    BitBoard Answers;
+    BitBoard Common;
+    bool     bThreatened = false;
+
+    // Every pawn of a threat reads the same cost squares, so only the lines through the attacker's pawns are looked at
+    for (int Index : Target.GetPawns(Attacker)) {
+        int Row    = Index / kBoardSize;
+        int Column = Index % kBoardSize;
+        for (int Direction = 0; Direction != 4; ++Direction) {
+            const LineThreat& Threat = _Threats[Target.GetLineKey(Row, Column, Direction, Attacker)];
+            if (Threat.Type == ThreatType::kNone || Threat.Type == ThreatType::kFive) {
+                continue;
+            }
+
+            BitBoard Cells = ToCells(Index, Direction, Threat.CostSquares);
+            Answers     = Answers | Cells;
+            Common      = bThreatened ? Common & Cells : Cells;
+            bThreatened = true;
+        }
+    }
+
+    Defenses = Common.Any() ? Common : Answers;
+    return bThreatened;
+}
+
+BitBoard ThreatSpace::ToCells(int Index, int Direction, std::uint8_t Squares) {
+    BitBoard Cells;
+    for (int Slot = 0; Slot != 8; ++Slot) {
+        if (Squares & (1 << Slot)) {
+            int Offset = Slot < 4 ? Slot - 4 : Slot - 3;
+            Cells.Set(Index + Offset * (Board::_kRowSteps[Direction] * kBoardSize + Board::_kColumnSteps[Direction]));
+        }
+    }
+    return Cells;
+}
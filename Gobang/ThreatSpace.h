@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "BitBoard.h"
+#include "Board.h"
+
+// Threats of the threat-space search. For every line key (see Board::GetLineKey) it holds the threat a pawn put at
+// the center makes on that line, and its cost squares, the cells where the defender can answer it. Built once from
+// the PatternTable and shared read-only like it
+class ThreatSpace {
+public:
+    enum class ThreatType : std::uint8_t {
+        kNone,
+        kThree,    // one more pawn makes an open four
+        kFour,     // one more pawn makes five, on one cell
+        kOpenFour, // one more pawn makes five, on two cells or more
+        kFive
+    };
+
+    struct LineThreat {
+        ThreatType   Type        = ThreatType::kNone;
+        std::uint8_t CostSquares = 0; // bit i for key slot i, offsets -4..-1 then 1..4
+    };
+
+public:
+    ThreatSpace(const ThreatSpace&) = delete;
+    ThreatSpace& operator=(const ThreatSpace&) = delete;
+
+    static const ThreatSpace& GetInstance();
+
+    // Strongest threat of a pawn of Type put on the empty cell Index, over the 4 lines
+    ThreatType GetThreat(const Board& Target, int Index, Board::PawnType Type) const;
+
+    // Cells where the defender answers every three and four of Attacker on the board, read from their cost squares.
+    // Returns false if Attacker has no such threat; if no single cell answers them all, Defenses holds every cost
+    // square instead
+    bool FindDefenses(const Board& Target, Board::PawnType Attacker, BitBoard& Defenses) const;
+
+private:
+    ThreatSpace();
+
+    static BitBoard ToCells(int Index, int Direction, std::uint8_t Squares);
+
+private:
+    std::array<LineThreat, 1 << 16> _Threats;
+};
@@ -0,0 +1,105 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <bit>
+
+TranspositionTable::TranspositionTable(std::size_t SizeInMB) : _BucketCount(0), _Generation(0) {
+    _BucketCount = std::bit_floor(std::max<std::size_t>(SizeInMB * 1024 * 1024 / sizeof(Bucket), 1));
+    _Buckets     = std::make_unique<Bucket[]>(_BucketCount);
+}
+
+bool TranspositionTable::Probe(std::uint64_t Key, Entry& Result) const {
+    for (const auto& Source : GetBucket(Key).Slots) {
+        Entry Current = Load(Source);
+        if (Current.Key == Key && Current.Bound != BoundType::kNone) {
+            Result = Current;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A miss on such a bucket means other positions of this search compete for the same slots
+bool TranspositionTable::IsBucketInUse(std::uint64_t Key) const {
+    std::uint8_t Generation = _Generation.load(std::memory_order_relaxed);
+    for (const auto& Source : GetBucket(Key).Slots) {
+        Entry Current = Load(Source);
+        if (Current.Bound != BoundType::kNone && Current.Generation == Generation) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::Store(std::uint64_t Key, int Score, int Depth, BoundType Bound, int BestMove) {
+    std::uint8_t Generation = _Generation.load(std::memory_order_relaxed);
+    Bucket&      Target     = GetBucket(Key);
+    Entry        NewEntry{ Key, Score, static_cast<std::int8_t>(Depth), Bound, Generation,
+                           BestMove < 0 ? kNoMove : static_cast<std::uint8_t>(BestMove) };
+
+    std::array<Entry, 4> Entries;
+    for (std::size_t i = 0; i != Entries.size(); ++i) {
+        Entries[i] = Load(Target.Slots[i]);
+        const Entry& Current = Entries[i];
+        if (Current.Key == Key && Current.Bound != BoundType::kNone) {
+            if (NewEntry.BestMove == kNoMove) {
+                NewEntry.BestMove = Current.BestMove;
+            }
+            if (Depth >= Current.Depth || Bound == BoundType::kExact || Current.Generation != Generation) {
+                Save(Target.Slots[i], NewEntry);
+            } else if (Current.BestMove != NewEntry.BestMove) {
+                Entry Updated    = Current;
+                Updated.BestMove = NewEntry.BestMove;
+                Save(Target.Slots[i], Updated);
+            }
+            return;
+        }
+    }
+
+    // Victim among the depth-preferred slots: empty first, then results of older searches, then the shallowest
+    std::size_t Victim = 0;
+    for (std::size_t i = 0; i != kDepthSlots; ++i) {
+        const Entry& Current = Entries[i];
+        if (Current.Bound == BoundType::kNone) {
+            Victim = i;
+            break;
+        }
+
+        bool bCurrentStale = Current.Generation         != Generation;
+        bool bVictimStale  = Entries[Victim].Generation != Generation;
+        if (bCurrentStale != bVictimStale ? bCurrentStale : Current.Depth < Entries[Victim].Depth) {
+            Victim = i;
+        }
+    }
+
+    const Entry& Replaced = Entries[Victim];
+    if (Replaced.Bound == BoundType::kNone || Replaced.Generation != Generation || Depth >= Replaced.Depth) {
+        Save(Target.Slots[Victim], NewEntry);
+    } else {
+        Save(Target.Slots[kDepthSlots], NewEntry);
+    }
+}
+
+TranspositionTable::Entry TranspositionTable::Load(const Slot& Source) {
+    std::uint64_t Check = Source.Check.load(std::memory_order_relaxed);
+    std::uint64_t Data  = Source.Data.load(std::memory_order_relaxed);
+
+    Entry Result;
+    Result.Key        = Check ^ Data;
+    Result.Score      = static_cast<std::int32_t>(static_cast<std::uint32_t>(Data));
+    Result.Depth      = static_cast<std::int8_t>(Data >> 32);
+    Result.Bound      = static_cast<BoundType>((Data >> 40) & 0xFF);
+    Result.Generation = static_cast<std::uint8_t>(Data >> 48);
+    Result.BestMove   = static_cast<std::uint8_t>(Data >> 56);
+    return Result;
+}
+
+void TranspositionTable::Save(Slot& Target, const Entry& Source) {
+    std::uint64_t Data = static_cast<std::uint32_t>(Source.Score) |
+                         static_cast<std::uint64_t>(static_cast<std::uint8_t>(Source.Depth)) << 32 |
+                         static_cast<std::uint64_t>(Source.Bound)      << 40 |
+                         static_cast<std::uint64_t>(Source.Generation) << 48 |
+                         static_cast<std::uint64_t>(Source.BestMove)   << 56;
+    Target.Check.store(Source.Key ^ Data, std::memory_order_relaxed);
+    Target.Data.store(Data, std::memory_order_relaxed);
+}
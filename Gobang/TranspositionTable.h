@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Shared by all search threads without locks, every slot keeps Key ^ Data next to Data so a torn write never validates
+class TranspositionTable {
+public:
+    enum class BoundType : std::uint8_t {
+        kNone, kExact, kLower, kUpper
+    };
+
+    struct Entry {
+        std::uint64_t Key        = 0;
+        int           Score      = 0;
+        std::int8_t   Depth      = 0;
+        BoundType     Bound      = BoundType::kNone;
+        std::uint8_t  Generation = 0;
+        std::uint8_t  BestMove   = kNoMove; // Board index
+    };
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> Check;
+        std::atomic<std::uint64_t> Data;
+    };
+
+    // The first kDepthSlots entries keep the deepest results, the last one is always replaced
+    struct alignas(64) Bucket {
+        std::array<Slot, 4> Slots;
+    };
+
+public:
+    static constexpr std::uint8_t kNoMove     = 0xFF;
+    static constexpr std::size_t  kDepthSlots = 3;
+
+public:
+    explicit TranspositionTable(std::size_t SizeInMB);
+
+    bool Probe(std::uint64_t Key, Entry& Result) const;
+    void Store(std::uint64_t Key, int Score, int Depth, BoundType Bound, int BestMove);
+    bool IsBucketInUse(std::uint64_t Key) const;
+
+    // Entries from earlier searches become the first candidates for replacement. Searches of other contexts may be
+    // running, hence the atomic generation
+    void NewSearch() {
+        _Generation.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::size_t GetSizeInBytes() const {
+        return _BucketCount * sizeof(Bucket);
+    }
+
+private:
+    static Entry Load(const Slot& Source);
+    static void Save(Slot& Target, const Entry& Source);
+
+    Bucket& GetBucket(std::uint64_t Key) const {
+        return _Buckets[Key & (_BucketCount - 1)];
+    }
+
+private:
+    std::unique_ptr<Bucket[]> _Buckets;
+    std::size_t               _BucketCount;
+    std::atomic<std::uint8_t> _Generation;
+};
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Evaluator.h"
+
+// Plays engine A against engine B, swapping colours every game. Game records go to --records as JSON lines,
+// the aggregate result is printed as one JSON object. Disjoint --first-game ranges let several processes share a run
+class SelfPlay {
+private:
+    struct EngineConfig {
+        int    MaxDepth       = 6;
+        int    MaxVcxDepth    = 10;    // 0 turns the threat solver off
+        bool   bProofNumber   = false; // df-pn instead of the depth limited solver
+        double Aggressiveness = 0.0;   // 0 picks the GUI defaults, 2.5 as black and 0.5 as white
+        int    SoftTime       = 0;     // milliseconds, 0 for no limit
+        int    HardTime       = 0;
+    };
+
+    struct GameRecord {
+        std::size_t         Index     = 0;
+        bool                bAIsBlack = true;
+        Board::PawnType     Winner    = Board::_kEmpty;
+        std::string         Moves;
+        std::vector<double> Latencies[2]; // milliseconds, [0] engine A, [1] engine B
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+    bool ParseArguments(int argc, char** argv) {
+        for (int i = 1; i < argc; i += 2) {
+            std::string_view Name = argv[i];
+            if (i + 1 == argc) {
+                std::cerr << "Missing value for " << Name << std::endl;
+                return false;
+            }
+
+            const char* Value = argv[i + 1];
+            if (Name == "--games") {
+                _GameCount = std::strtoul(Value, nullptr, 10);
+            } else if (Name == "--first-game") {
+                _FirstGame = std::strtoul(Value, nullptr, 10);
+            } else if (Name == "--threads") {
+                _ThreadCount = std::max<std::size_t>(std::strtoul(Value, nullptr, 10), 1);
+            } else if (Name == "--seed") {
+                _Seed = std::strtoull(Value, nullptr, 10);
+            } else if (Name == "--opening-moves") {
+                // More moves than the opening square has cells could never be placed
+                _OpeningMoves = std::clamp(std::atoi(Value), 0, _kOpeningSize * _kOpeningSize);
+            } else if (Name == "--table-mb") {
+                _TableSizeInMB = std::strtoul(Value, nullptr, 10);
+            } else if (Name == "--records") {
+                _RecordPath = Value;
+            } else if (!ParseEngineArgument(Name, Value)) {
+                std::cerr << "Unknown option: " << Name << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Run() {
+        std::ofstream Records;
+        if (!_RecordPath.empty()) {
+            Records.open(_RecordPath);
+        }
+
+        std::atomic<std::size_t> NextGame(0);
+        std::vector<GameRecord>  Games(_GameCount);
+        std::vector<std::thread> Workers;
+        std::mutex               RecordMutex;
+        auto                     BeginTime = Clock::now();
+        for (std::size_t i = 0; i != std::min(_ThreadCount, _GameCount); ++i) {
+            Workers.emplace_back([&]() -> void {
+                for (std::size_t Game = NextGame++; Game < _GameCount; Game = NextGame++) {
+                    Games[Game] = PlayGame(_FirstGame + Game);
+                    if (Records.is_open()) {
+                        std::lock_guard<std::mutex> Lock(RecordMutex);
+                        Records << ToJson(Games[Game]) << std::endl;
+                    }
+                }
+            });
+        }
+        for (auto& Worker : Workers) {
+            Worker.join();
+        }
+
+        std::cout << Summarize(Games, std::chrono::duration<double>(Clock::now() - BeginTime).count()) << std::endl;
+    }
+
+private:
+    bool ParseEngineArgument(std::string_view Name, const char* Value) {
+        if (Name.size() < 5 || !Name.starts_with("--") || (Name[2] != 'a' && Name[2] != 'b') || Name[3] != '-') {
+            return false;
+        }
+
+        EngineConfig&    Config = _Engines[Name[2] == 'a' ? 0 : 1];
+        std::string_view Field  = Name.substr(4);
+        if (Field == "depth") {
+            Config.MaxDepth = std::atoi(Value);
+        } else if (Field == "vcx-depth") {
+            Config.MaxVcxDepth = std::atoi(Value);
+        } else if (Field == "solver") {
+            if (std::string_view(Value) != "dfpn" && std::string_view(Value) != "deepening") {
+                return false;
+            }
+            Config.bProofNumber = std::string_view(Value) == "dfpn";
+        } else if (Field == "aggressiveness") {
+            Config.Aggressiveness = std::atof(Value);
+        } else if (Field == "soft-ms") {
+            Config.SoftTime = std::atoi(Value);
+        } else if (Field == "hard-ms") {
+            Config.HardTime = std::atoi(Value);
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    // Every game gets fresh engines seeded from its index, so a game replays the same wherever it runs
+    GameRecord PlayGame(std::size_t Index) {
+        GameRecord Record;
+        Record.Index     = Index;
+        Record.bAIsBlack = Index % 2 == 0;
+
+        std::uint64_t Seed   = _Seed + Index;
+        auto          Target = std::make_shared<Board>();
+
+        std::unique_ptr<Evaluator> Engines[2];
+        for (Board::PawnType Side : { Board::_kBlack, Board::_kWhite }) {
+            const EngineConfig& Config = GetConfig(Record, Side);
+            double Aggressiveness = Config.Aggressiveness > 0.0 ? Config.Aggressiveness : (Side == Board::_kBlack ? 2.5 : 0.5);
+            Engines[Side - 1] = std::make_unique<Evaluator>(Target, Side, Aggressiveness, _TableSizeInMB, 1);
+            Engines[Side - 1]->SetSeed(Seed);
+        }
+
+        Board::PawnType Type = PlayOpening(*Target, *Engines[0], Seed, Record.Moves);
+
+        while (Target->GetPawnCount() < kCellCount) {
+            const EngineConfig& Config = GetConfig(Record, Type);
+
+            Evaluator::SearchLimits Limits;
+            Limits.MaxDepth         = Config.MaxDepth;
+            Limits.bProcessCalcKill = Config.MaxVcxDepth > 0;
+            Limits.MaxVcxDepth      = Config.MaxVcxDepth;
+            Limits.Solver           = Config.bProofNumber ? Evaluator::VcxSolver::kProofNumber : Evaluator::VcxSolver::kDeepening;
+            Limits.SoftTime         = std::chrono::milliseconds(Config.SoftTime);
+            Limits.HardTime         = std::chrono::milliseconds(Config.HardTime);
+
+            auto            BeginTime = Clock::now();
+            Board::PawnInfo Move      = Engines[Type - 1]->GetBestMove(Limits);
+            Record.Latencies[(Type == Board::_kBlack) == Record.bAIsBlack ? 0 : 1].push_back(
+                std::chrono::duration<double, std::milli>(Clock::now() - BeginTime).count());
+
+            Move.Type = Type;
+            if (!Target->PutPawn(Move, true, false).second) {
+                Record.Winner = 3 - Type; // an illegal move loses
+                break;
+            }
+            AppendMove(Record.Moves, Move);
+
+            if (Engines[Type - 1]->IsGameOver(Move)) {
+                Record.Winner = Target->GetPawnCount() == kCellCount ? Board::_kEmpty : Type;
+                break;
+            }
+            Type = 3 - Type;
+        }
+
+        return Record;
+    }
+
+    // Random moves inside the central square keep games from repeating, returns the side to move next. Referee plays
+    // on Target; an opening that already holds a five is thrown away and drawn again from the same random stream
+    Board::PawnType PlayOpening(Board& Target, const Evaluator& Referee, std::uint64_t Seed, std::string& Moves) const {
+        std::mt19937_64 Engine(Seed);
+        Board::PawnType Type = Board::_kBlack;
+        for (int i = 0; i != _OpeningMoves; ++i) {
+            Board::PawnInfo Move{};
+            do {
+                Move = { _kOpeningFirst + static_cast<int>(Engine() % _kOpeningSize),
+                         _kOpeningFirst + static_cast<int>(Engine() % _kOpeningSize), Type };
+            } while (Target.GetPawn(Move.Row, Move.Column) != Board::_kEmpty);
+
+            Target.PutPawn(Move, true, false);
+            AppendMove(Moves, Move);
+            Type = 3 - Type;
+
+            if (Referee.IsGameOver(Move)) {
+                Target = Board();
+                Moves.clear();
+                Type = Board::_kBlack;
+                i    = -1;
+            }
+        }
+
+        return Type;
+    }
+
+    const EngineConfig& GetConfig(const GameRecord& Record, Board::PawnType Side) const {
+        return _Engines[(Side == Board::_kBlack) == Record.bAIsBlack ? 0 : 1];
+    }
+
+    std::string ToJson(const GameRecord& Record) const {
+        static const char* const kResults[] = { "draw", "black", "white" };
+
+        std::ostringstream Stream;
+        Stream << "{\"game\":" << Record.Index << ",\"black\":\"" << (Record.bAIsBlack ? "a" : "b")
+               << "\",\"result\":\"" << kResults[Record.Winner] << "\",\"moves\":\"" << Record.Moves << "\"}";
+
+        return Stream.str();
+    }
+
+    std::string Summarize(const std::vector<GameRecord>& Games, double Seconds) const {
+        std::size_t         Wins[2] = {};
+        std::size_t         Draws   = 0;
+        std::size_t         Moves   = 0;
+        std::vector<double> Latencies[2];
+        for (const auto& Record : Games) {
+            if (Record.Winner == Board::_kEmpty) {
+                ++Draws;
+            } else {
+                ++Wins[(Record.Winner == Board::_kBlack) == Record.bAIsBlack ? 0 : 1];
+            }
+
+            for (int i = 0; i != 2; ++i) {
+                Moves += Record.Latencies[i].size();
+                Latencies[i].insert(Latencies[i].end(), Record.Latencies[i].begin(), Record.Latencies[i].end());
+            }
+        }
+
+        std::ostringstream Stream;
+        Stream << "{\"games\":" << Games.size() << ",\"a_wins\":" << Wins[0] << ",\"b_wins\":" << Wins[1] << ",\"draws\":" << Draws
+               << ",\"a_score\":" << (Games.empty() ? 0.0 : (Wins[0] + 0.5 * Draws) / Games.size())
+               << ",\"engine_moves\":" << Moves << ",\"seconds\":" << Seconds
+               << ",\"moves_per_second\":" << (Seconds > 0.0 ? Moves / Seconds : 0.0)
+               << ",\"latency_ms\":{\"a\":" << SummarizeLatencies(Latencies[0])
+               << ",\"b\":" << SummarizeLatencies(Latencies[1]) << "}}";
+
+        return Stream.str();
+    }
+
+    static std::string SummarizeLatencies(std::vector<double>& Latencies) {
+        std::sort(Latencies.begin(), Latencies.end());
+        auto Percentile = [&Latencies](double Rank) -> double {
+            return Latencies.empty() ? 0.0 : Latencies[static_cast<std::size_t>(Rank * (Latencies.size() - 1))];
+        };
+
+        std::ostringstream Stream;
+        Stream << "{\"p50\":" << Percentile(0.5) << ",\"p90\":" << Percentile(0.9) << ",\"p99\":" << Percentile(0.99)
+               << ",\"max\":" << Percentile(1.0) << "}";
+
+        return Stream.str();
+    }
+
+    static void AppendMove(std::string& Moves, const Board::PawnInfo& Move) {
+        if (!Moves.empty()) {
+            Moves += ' ';
+        }
+        Moves += std::to_string(Move.Row) + ',' + std::to_string(Move.Column);
+    }
+
+private:
+    static constexpr int _kOpeningSize  = 5;
+    static constexpr int _kOpeningFirst = (kBoardSize - _kOpeningSize) / 2;
+
+    EngineConfig  _Engines[2];
+    std::size_t   _GameCount     = 100;
+    std::size_t   _FirstGame     = 0;
+    std::size_t   _ThreadCount   = std::max(std::thread::hardware_concurrency(), 1U);
+    std::uint64_t _Seed          = 1;
+    int           _OpeningMoves  = 2;
+    std::size_t   _TableSizeInMB = 4;
+    std::string   _RecordPath;
+};
+
+int main(int argc, char** argv) {
+    SelfPlay Driver;
+    if (!Driver.ParseArguments(argc, argv)) {
+        std::cerr << "Usage: GobangSelfPlay [--games N] [--first-game N] [--threads N] [--seed N] [--opening-moves N]\n"
+                     "                      [--table-mb N] [--records FILE]\n"
+                     "                      [--{a,b}-depth N] [--{a,b}-vcx-depth N] [--{a,b}-aggressiveness X]\n"
+                     "                      [--{a,b}-soft-ms N] [--{a,b}-hard-ms N] [--{a,b}-solver deepening|dfpn]" << std::endl;
+        return 1;
+    }
+
+    Driver.Run();
+
+    return 0;
+}
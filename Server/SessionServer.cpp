@@ -0,0 +1,315 @@
+#include "SessionServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+SessionServer::SessionServer(std::size_t WorkerCount, std::size_t MemoryLimitInMB, std::size_t SessionLimitInMB) :
+    _MemoryLimitInBytes(MemoryLimitInMB * 1024 * 1024), _SessionLimitInMB(std::max(SessionLimitInMB, _kMinTableSizeInMB + GetBufferSizeInMB())),
+    _MemoryInUse(0),
+    _QueuedCommands(0), _RunningCommands(0), _bQuit(false)
+{
+    for (std::size_t i = 0; i != std::max<std::size_t>(WorkerCount, 1); ++i) {
+        _Workers.emplace_back(&SessionServer::WorkerLoop, this);
+    }
+}
+
+SessionServer::~SessionServer() {
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _bQuit = true;
+    }
+    _Condition.notify_all();
+    for (auto& Worker : _Workers) {
+        if (Worker.joinable()) {
+            Worker.join();
+        }
+    }
+}
+
+void SessionServer::Run(std::istream& Input) {
+    std::string Line;
+    while (std::getline(Input, Line)) {
+        Command Request = Parse(Line);
+        if (Request.Name.empty()) {
+            continue;
+        }
+        if (Request.Name == "quit") {
+            break;
+        }
+
+        Dispatch(Request);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _bQuit = true;
+    }
+    _Condition.notify_all();
+    for (auto& Worker : _Workers) {
+        Worker.join();
+    }
+}
+
+void SessionServer::Dispatch(const Command& Request) {
+    if (Request.Name == "new") {
+        CreateSession(Request);
+        return;
+    }
+
+    if (Request.Name == "stats") {
+        std::ostringstream Stream;
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            Stream << "stats sessions " << _Sessions.size() << " memory-mb " << _MemoryInUse / (1024.0 * 1024.0)
+                   << " queued " << _QueuedCommands + _RunningCommands;
+        }
+        Reply(Stream.str());
+        return;
+    }
+
+    if (Request.Arguments.empty()) {
+        Reply("error - missing session id");
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(_Mutex);
+    auto Found = _Sessions.find(Request.Arguments.front());
+    if (Found == _Sessions.end()) {
+        Reply("error " + Request.Arguments.front() + " unknown session");
+        return;
+    }
+
+    Found->second->Pending.push(Request);
+    ++_QueuedCommands;
+    ScheduleLocked(Found->second);
+}
+
+void SessionServer::CreateSession(const Command& Request) {
+    if (Request.Arguments.empty()) {
+        Reply("error - missing session id");
+        return;
+    }
+
+    auto Target = std::make_shared<Session>();
+    Target->Id  = Request.Arguments.front();
+
+    std::size_t TableSizeInMB = _SessionLimitInMB;
+    for (std::size_t i = 1; i < Request.Arguments.size(); ++i) {
+        const std::string& Name = Request.Arguments[i];
+        if (Name == "black" || Name == "white") {
+            Target->EngineSide = Name == "black" ? Board::_kBlack : Board::_kWhite;
+            continue;
+        }
+        if (i + 1 == Request.Arguments.size()) {
+            Reply("error " + Target->Id + " missing value for " + Name);
+            return;
+        }
+
+        int Value = std::atoi(Request.Arguments[++i].c_str());
+        if (Name == "depth") {
+            Target->Limits.MaxDepth = Value;
+        } else if (Name == "vcx") {
+            Target->Limits.bProcessCalcKill = Value > 0;
+            Target->Limits.MaxVcxDepth      = Value;
+        } else if (Name == "soft-ms") {
+            Target->Limits.SoftTime = std::chrono::milliseconds(Value);
+        } else if (Name == "hard-ms") {
+            Target->Limits.HardTime = std::chrono::milliseconds(Value);
+        } else if (Name == "table-mb") {
+            TableSizeInMB = std::clamp<std::size_t>(Value, _kMinTableSizeInMB + GetBufferSizeInMB(), _SessionLimitInMB);
+        } else {
+            Reply("error " + Target->Id + " unknown option " + Name);
+            return;
+        }
+    }
+
+    // Both checks come before the engine is made. It never exceeds the requested size, so that is reserved up front and
+    // settled afterwards; sessions are only created on the reading thread, nothing can take the id meanwhile
+    std::size_t RequestedBytes = TableSizeInMB * 1024 * 1024;
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        if (_Sessions.contains(Target->Id)) {
+            Reply("error " + Target->Id + " session exists");
+            return;
+        }
+        if (_MemoryInUse + RequestedBytes > _MemoryLimitInBytes) {
+            Reply("error " + Target->Id + " memory limit");
+            return;
+        }
+
+        _MemoryInUse += RequestedBytes;
+    }
+
+    // Sessions search one at a time on a worker, helper threads would only compete with the other sessions.
+    // The move lists are made here so the budget covers them; of what is left the two proof tables get a sixth each,
+    // the transposition table the rest
+    TableSizeInMB -= GetBufferSizeInMB();
+    std::size_t ProofTableSizeInMB = std::max<std::size_t>(TableSizeInMB / 6, 1);
+    Target->GameBoard = std::make_shared<Board>();
+    Target->Engine    = std::make_unique<Evaluator>(Target->GameBoard, Target->EngineSide,
+                                                    Target->EngineSide == Board::_kBlack ? 2.5 : 0.5,
+                                                    TableSizeInMB - 2 * ProofTableSizeInMB, 1, ProofTableSizeInMB);
+    Target->Engine->ReserveMoveLists();
+    Target->MemoryInBytes = Target->Engine->GetSizeInBytes();
+
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _MemoryInUse = _MemoryInUse - RequestedBytes + Target->MemoryInBytes;
+        _Sessions.emplace(Target->Id, Target);
+    }
+    Reply("ok " + Target->Id);
+}
+
+// A session is queued once at most; it goes back to the end of the queue after each command
+void SessionServer::ScheduleLocked(const std::shared_ptr<Session>& Target) {
+    if (!Target->bScheduled) {
+        Target->bScheduled = true;
+        _ReadyQueue.push_back(Target);
+        _Condition.notify_one();
+    }
+}
+
+void SessionServer::WorkerLoop() {
+    while (true) {
+        std::shared_ptr<Session> Target;
+        Command                  Request;
+        {
+            std::unique_lock<std::mutex> Lock(_Mutex);
+            _Condition.wait(Lock, [this]() -> bool { return _bQuit || !_ReadyQueue.empty(); });
+            if (_ReadyQueue.empty()) {
+                return;
+            }
+
+            Target = _ReadyQueue.front();
+            _ReadyQueue.pop_front();
+            Request = std::move(Target->Pending.front());
+            Target->Pending.pop();
+            --_QueuedCommands;
+            ++_RunningCommands;
+        }
+
+        Execute(*Target, Request);
+
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            --_RunningCommands;
+            Target->bScheduled = false;
+            if (!Target->Pending.empty()) {
+                ScheduleLocked(Target);
+            }
+        }
+    }
+}
+
+void SessionServer::Execute(Session& Target, const Command& Request) {
+    if (Target.bClosed) {
+        Reply("error " + Target.Id + " unknown session");
+    } else if (Request.Name == "play") {
+        PlayMove(Target, Request);
+    } else if (Request.Name == "go") {
+        SearchMove(Target);
+    } else if (Request.Name == "close") {
+        CloseSession(Target);
+    } else {
+        Reply("error " + Target.Id + " unknown command " + Request.Name);
+    }
+}
+
+void SessionServer::PlayMove(Session& Target, const Command& Request) {
+    if (Request.Arguments.size() < 3) {
+        Reply("error " + Target.Id + " play needs a row and a column");
+        return;
+    }
+
+    Board::PawnInfo Move{ std::atoi(Request.Arguments[1].c_str()), std::atoi(Request.Arguments[2].c_str()), 3 - Target.EngineSide };
+    if (!Target.bGameOver && GetSideToMove(*Target.GameBoard) != Move.Type) {
+        Reply("error " + Target.Id + " not your turn");
+        return;
+    }
+    if (Target.bGameOver || Move.Row < 0 || Move.Row >= kBoardSize || Move.Column < 0 || Move.Column >= kBoardSize ||
+        !Target.GameBoard->PutPawn(Move, true, false).second) {
+        Reply("error " + Target.Id + " illegal move");
+        return;
+    }
+
+    if (Target.Engine->IsGameOver(Move)) {
+        Target.bGameOver = true;
+        Reply("over " + Target.Id + " " + GetPawnName(Target.GameBoard->GetPawnCount() == kCellCount ? Board::_kEmpty : Move.Type));
+    } else {
+        Reply("ok " + Target.Id);
+    }
+}
+
+void SessionServer::SearchMove(Session& Target) {
+    if (Target.bGameOver) {
+        Reply("error " + Target.Id + " game over");
+        return;
+    }
+    if (GetSideToMove(*Target.GameBoard) != Target.EngineSide) {
+        Reply("error " + Target.Id + " not the engine's turn");
+        return;
+    }
+
+    Board::PawnInfo Move{ kBoardSize / 2, kBoardSize / 2, Target.EngineSide };
+    if (Target.GameBoard->GetPawnCount() != 0) {
+        Move      = Target.Engine->GetBestMove(Target.Limits);
+        Move.Type = Target.EngineSide;
+    }
+    Target.GameBoard->PutPawn(Move, true, false);
+
+    std::string Line = "move " + Target.Id + " " + std::to_string(Move.Row) + " " + std::to_string(Move.Column);
+    if (Target.Engine->IsGameOver(Move)) {
+        Target.bGameOver = true;
+        Line += std::string(" over ") + GetPawnName(Target.GameBoard->GetPawnCount() == kCellCount ? Board::_kEmpty : Move.Type);
+    }
+    Reply(Line);
+}
+
+void SessionServer::CloseSession(Session& Target) {
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _Sessions.erase(Target.Id);
+        _MemoryInUse -= Target.MemoryInBytes;
+        Target.bClosed = true;
+    }
+
+    // Commands queued behind the close still hold the session, the tables are released right away
+    Target.Engine.reset();
+    Reply("closed " + Target.Id);
+}
+
+void SessionServer::Reply(const std::string& Line) {
+    std::lock_guard<std::mutex> Lock(_OutputMutex);
+    std::cout << Line << std::endl;
+}
+
+// Rounded up, the tables are sized in whole megabytes
+std::size_t SessionServer::GetBufferSizeInMB() {
+    return (SearchContext::GetBufferSizeInBytes() + 1024 * 1024 - 1) / (1024 * 1024);
+}
+
+SessionServer::Command SessionServer::Parse(const std::string& Line) {
+    Command            Request;
+    std::istringstream Stream(Line);
+    Stream >> Request.Name;
+
+    std::string Argument;
+    while (Stream >> Argument) {
+        Request.Arguments.push_back(Argument);
+    }
+
+    return Request;
+}
+
+// Black moves first
+Board::PawnType SessionServer::GetSideToMove(const Board& Target) {
+    return Target.GetPawnCount() % 2 == 0 ? Board::_kBlack : Board::_kWhite;
+}
+
+const char* SessionServer::GetPawnName(Board::PawnType Type) {
+    static const char* const kNames[] = { "draw", "black", "white" };
+    return kNames[Type];
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.h"
+#include "Evaluator.h"
+
+// Hosts many games in one process. Commands of a session run in order, sessions take turns on a fixed worker pool
+// one command at a time, so a session with a long queue never holds back the others.
+//
+// Protocol, one command per line, one reply line per command:
+//   new <id> [black|white] [depth N] [vcx N] [soft-ms N] [hard-ms N] [table-mb N]  -> ok <id> | error <id> <reason>
+//   play <id> <row> <column>                                                         -> ok <id> | over <id> <winner> | error ...
+//   go <id>                                                                          -> move <id> <row> <column> [over <winner>] | error ...
+//   close <id>                                                                       -> closed <id>
+//   stats                                                                            -> stats sessions <n> memory-mb <x> queued <n>
+//   quit
+// play places the pawn of the side the engine does not play, play and go are refused when it is not that side's turn
+class SessionServer {
+private:
+    struct Command {
+        std::string              Name;
+        std::vector<std::string> Arguments;
+    };
+
+    struct Session {
+        std::string                Id;
+        std::shared_ptr<Board>     GameBoard;
+        std::unique_ptr<Evaluator> Engine;
+        Evaluator::SearchLimits    Limits;
+        Board::PawnType            EngineSide    = Board::_kWhite;
+        std::size_t                MemoryInBytes = 0;
+        std::queue<Command>        Pending;
+        bool                       bScheduled    = false; // in the ready queue or running on a worker
+        bool                       bGameOver     = false;
+        bool                       bClosed       = false;
+    };
+
+public:
+    // MemoryLimitInMB bounds all sessions together, SessionLimitInMB the engine of one: its transposition and proof
+    // tables, which need at least _kMinTableSizeInMB, and the buffers of its search context
+    SessionServer(std::size_t WorkerCount, std::size_t MemoryLimitInMB, std::size_t SessionLimitInMB);
+    SessionServer(const SessionServer&) = delete;
+    ~SessionServer();
+
+    // Returns at end of input or on quit, after every queued command has been answered
+    void Run(std::istream& Input);
+
+private:
+    void Dispatch(const Command& Request);
+    void CreateSession(const Command& Request);
+    void ScheduleLocked(const std::shared_ptr<Session>& Target);
+    void WorkerLoop();
+    void Execute(Session& Target, const Command& Request);
+    void PlayMove(Session& Target, const Command& Request);
+    void SearchMove(Session& Target);
+    void CloseSession(Session& Target);
+    void Reply(const std::string& Line);
+
+    static std::size_t GetBufferSizeInMB();
+    static Command Parse(const std::string& Line);
+    static Board::PawnType GetSideToMove(const Board& Target);
+    static const char* GetPawnName(Board::PawnType Type);
+
+private:
+    static constexpr std::size_t _kMinTableSizeInMB = 3; // a megabyte per table
+
+    std::size_t _MemoryLimitInBytes;
+    std::size_t _SessionLimitInMB;
+    std::size_t _MemoryInUse;
+
+    std::unordered_map<std::string, std::shared_ptr<Session>> _Sessions;
+    std::deque<std::shared_ptr<Session>>                      _ReadyQueue;
+    std::vector<std::thread>                                  _Workers;
+    std::mutex                                                _Mutex;
+    std::mutex                                                _OutputMutex;
+    std::condition_variable                                   _Condition;
+    std::size_t                                               _QueuedCommands;
+    std::size_t                                               _RunningCommands;
+    bool                                                      _bQuit;
+};
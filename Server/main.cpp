@@ -0,0 +1,35 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+#include "SessionServer.h"
+
+int main(int argc, char** argv) {
+    std::size_t WorkerCount      = std::max(std::thread::hardware_concurrency(), 1U);
+    std::size_t MemoryLimitInMB  = 1024;
+    std::size_t SessionLimitInMB = 24;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view Name  = argv[i];
+        std::size_t      Value = std::strtoul(argv[i + 1], nullptr, 10);
+        if (Name == "--workers") {
+            WorkerCount = Value;
+        } else if (Name == "--memory-mb") {
+            MemoryLimitInMB = Value;
+        } else if (Name == "--session-mb") {
+            SessionLimitInMB = Value;
+        } else {
+            std::cerr << "Usage: GobangServer [--workers N] [--memory-mb N] [--session-mb N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Replies come from the workers under a lock, so reading must not flush std::cout through the tie
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    SessionServer Server(WorkerCount, MemoryLimitInMB, SessionLimitInMB);
+    Server.Run(std::cin);
+
+    return 0;
+}